@@ -0,0 +1,828 @@
+/*
+ * si5351_bench.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351.h"
+#include "si5351_sim.h"
+#include "si5351_plan.h"
+#include "si5351_table.h"
+#include "si5351_step.h"
+#include "si5351_fsk.h"
+#include "si5351_stream.h"
+#include "si5351_event.h"
+#include "si5351_watchdog.h"
+#include "si5351_config.h"
+#include "si5351_snapshot.h"
+#include "si5351_private.h"
+#include <string.h>
+
+
+// Bus traffic of every scenario is measured on the simulator and checked
+// against the budget below. Lower a budget when a change saves traffic,
+// never raise one without a reason in the commit message.
+typedef struct {
+    const char* name;
+    si5351_err_t (*setup)(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+    si5351_err_t (*run)(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+    uint32_t transactions_max;
+    uint32_t bytes_max;
+} si5351_bench_t;
+
+
+// function prototype
+si5351_err_t si5351_bench_setup_power_cycle(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_init(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_bringup(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_table(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_step(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_vfo(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_fsk(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_stream(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_event(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_reset(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_brownout(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_config(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_snapshot(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_setup_pllb(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_cold_init(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_unbreakable_init(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_set_pll_vco(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_set_multisynth(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_set_clk(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_set_output_frequency(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_apply_table_entry(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_set_vfo_frequency(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_vfo_band_change(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_set_pingpong_frequency(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_pingpong_new_divider(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_group_toggle(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_clk_controls(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_bringup(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_retune_sweep(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_step_sweep(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_fsk_wspr(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_stream_fm(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_event_lol(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_wait_lock(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_watchdog_check(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+void si5351_bench_loss_of_lock(void* ctx, si5351_pll_reg_t pll, bool active);
+si5351_err_t si5351_bench_config_apply(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_profile_switch(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_phase_apply(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_config_reject(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+void si5351_bench_set_config(si5351_config_t* config, uint16_t clk2_divider);
+si5351_err_t si5351_bench_snapshot_boot(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_plan_apply(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_plan_capped(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus);
+si5351_err_t si5351_bench_plan_targets_apply(si5351_t* dev, si5351_sim_t* sim, const si5351_plan_target_t* targets, uint8_t count);
+bool si5351_bench_is_clk_frequency(si5351_sim_t* sim, si5351_ms_clk_reg_t clk, uint64_t frequency);
+bool si5351_bench_is_bringup_frequency(si5351_sim_t* sim);
+bool si5351_bench_is_frequency(double frequency, uint64_t expected, uint64_t tolerance);
+void si5351_bench_watch(si5351_bus_t* bus, si5351_ms_clk_reg_t clk);
+si5351_err_t si5351_bench_watch_write(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count);
+si5351_err_t si5351_bench_watch_write_bursts(void* ctx, uint8_t i2c_addr, si5351_burst_t* bursts, uint8_t count);
+void si5351_bench_watch_check(si5351_sim_t* sim);
+
+
+#define SI5351_BENCH_XTAL               25000000UL
+#define SI5351_BENCH_SWEEP_STEPS        1000
+#define SI5351_BENCH_SWEEP_START        7000000UL
+#define SI5351_BENCH_SWEEP_STEP         100UL
+#define SI5351_BENCH_STEP_START         2343750000ULL
+#define SI5351_BENCH_STEP_DELTA         10000LL
+#define SI5351_BENCH_GROUP              0x07
+#define SI5351_BENCH_WSPR_SYMBOLS       162
+#define SI5351_BENCH_WSPR_SPACING       1465ULL
+#define SI5351_BENCH_WSPR_SYMBOL_nsec   682666667ULL
+#define SI5351_BENCH_FM_SAMPLES         1000
+#define SI5351_BENCH_FM_RATE            8000UL
+#define SI5351_BENCH_FM_DEVIATION       2500000L
+#define SI5351_BENCH_VFO_LOW_BAND       1838100000ULL
+// mHz, the sim against the requested output frequency
+#define SI5351_BENCH_CLK_TOLERANCE      10
+// the outputs of the bring-up: 600 MHz / 1768.868 / 128 on CLK0 and CLK1, 600 MHz / 4 / 64 on CLK2
+#define SI5351_BENCH_BRINGUP_CLK0       2650000ULL
+#define SI5351_BENCH_BRINGUP_CLK2       2343750000ULL
+// 0 runs the scenarios and their checks without the bus budgets, for the build without the register cache
+#ifndef SI5351_BENCH_BUDGETS
+#define SI5351_BENCH_BUDGETS            1
+#endif
+
+const uint64_t si5351_bench_tones[] = { 14097100000ULL, 14097101465ULL, 14097102930ULL, 14097104395ULL };
+si5351_table_entry_t si5351_bench_table[sizeof(si5351_bench_tones) / sizeof(si5351_bench_tones[0])];
+si5351_step_t si5351_bench_step;
+si5351_table_entry_t si5351_bench_fsk_tones[sizeof(si5351_bench_tones) / sizeof(si5351_bench_tones[0])];
+uint8_t si5351_bench_symbols[SI5351_BENCH_WSPR_SYMBOLS];
+si5351_fsk_t si5351_bench_fsk;
+int32_t si5351_bench_fm_samples[SI5351_BENCH_FM_SAMPLES];
+int32_t si5351_bench_stream_buffer[SI5351_BENCH_FM_SAMPLES];
+si5351_stream_t si5351_bench_stream;
+si5351_events_t si5351_bench_events;
+si5351_watchdog_t si5351_bench_watchdog;
+uint8_t si5351_bench_lol_seen;
+si5351_config_t si5351_bench_config;
+si5351_plan_t si5351_bench_plan;
+// two outputs without a common VCO and a low one, the last free PLL has to stay below 695 MHz
+const si5351_plan_target_t si5351_bench_plan_targets[] = {
+    { SI5351_MS_CLK0, 25000000 }, { SI5351_MS_CLK1, 27000000 }, { SI5351_MS_CLK2, 2650 }
+};
+// 150 MHz takes PLLA at 900 MHz, 95 MHz has no even divider below the 695 MHz of 2650 Hz,
+// so 2650 Hz leads PLLB and 95 MHz goes fractional on PLLA
+const si5351_plan_target_t si5351_bench_plan_capped_targets[] = {
+    { SI5351_MS_CLK0, 150000000 }, { SI5351_MS_CLK1, 95000000 }, { SI5351_MS_CLK2, 2650 }
+};
+uint8_t si5351_bench_snapshot[SI5351_SNAPSHOT_LENGTH];
+// the simulator's own bus callbacks and the output checked after each of its writes
+si5351_bus_t si5351_bench_watched_bus;
+si5351_ms_clk_reg_t si5351_bench_watched_clk;
+bool si5351_bench_watched_in_range;
+const si5351_event_handlers_t si5351_bench_event_handlers = {
+    .loss_of_lock = si5351_bench_loss_of_lock,
+    .loss_of_signal = NULL,
+    .sys_init = NULL,
+    .ctx = &si5351_bench_lol_seen
+};
+
+const si5351_bench_t si5351_benches[] = {
+    { "cold_init",          si5351_bench_setup_power_cycle, si5351_bench_cold_init,         8,      65 },
+    { "unbreakable_init",   si5351_bench_setup_bringup,     si5351_bench_unbreakable_init,  6,      145 },
+    { "set_pll_vco",        si5351_bench_setup_init,        si5351_bench_set_pll_vco,       1,      10 },
+    { "set_multisynth",     si5351_bench_setup_bringup,     si5351_bench_set_multisynth,    2,      13 },
+    { "set_clk",            si5351_bench_setup_bringup,     si5351_bench_set_clk,           2,      6 },
+    { "set_output_freq",    si5351_bench_setup_bringup,     si5351_bench_set_output_frequency, 1,  10 },
+    { "table_apply",        si5351_bench_setup_table,       si5351_bench_apply_table_entry, 1,      10 },
+    { "vfo_retune",         si5351_bench_setup_vfo,         si5351_bench_set_vfo_frequency, 1,      9 },
+    { "vfo_band_change",    si5351_bench_setup_vfo,         si5351_bench_vfo_band_change,   6,      32 },
+    { "pingpong_hop",       si5351_bench_setup_bringup,     si5351_bench_set_pingpong_frequency, 7,  32 },
+    { "pingpong_divider",   si5351_bench_setup_bringup,     si5351_bench_pingpong_new_divider, 8,  41 },
+    { "group_toggle",       si5351_bench_setup_bringup,     si5351_bench_group_toggle,      4,      16 },
+    { "clk_controls",       si5351_bench_setup_pllb,        si5351_bench_clk_controls,      1,      10 },
+    { "bringup",            si5351_bench_setup_init,        si5351_bench_bringup,           22,     97 },
+    { "retune_sweep",       si5351_bench_setup_bringup,     si5351_bench_retune_sweep,      2000,   13000 },
+    { "step_sweep",         si5351_bench_setup_step,        si5351_bench_step_sweep,        1000,   3235 },
+    { "fsk_wspr",           si5351_bench_setup_fsk,         si5351_bench_fsk_wspr,          162,    622 },
+    { "stream_fm",          si5351_bench_setup_stream,      si5351_bench_stream_fm,         500,    2625 },
+    { "event_lol",          si5351_bench_setup_event,       si5351_bench_event_lol,         2,      8 },
+    { "wait_lock",          si5351_bench_setup_reset,       si5351_bench_wait_lock,         4,      16 },
+    { "watchdog_idle",      si5351_bench_setup_bringup,     si5351_bench_watchdog_check,    1,      27 },
+    { "watchdog_heal",      si5351_bench_setup_brownout,    si5351_bench_watchdog_check,    17,     141 },
+    { "config_apply",       si5351_bench_setup_init,        si5351_bench_config_apply,      10,     78 },
+    { "profile_switch",     si5351_bench_setup_config,      si5351_bench_profile_switch,    1,      4 },
+    { "phase_apply",        si5351_bench_setup_config,      si5351_bench_phase_apply,       7,      28 },
+    { "config_reject",      si5351_bench_setup_config,      si5351_bench_config_reject,     7,      28 },
+    { "snapshot_boot",      si5351_bench_setup_snapshot,    si5351_bench_snapshot_boot,     15,     185 },
+    { "plan_apply",         si5351_bench_setup_init,        si5351_bench_plan_apply,        7,      75 },
+    { "plan_capped",        si5351_bench_setup_init,        si5351_bench_plan_capped,       7,      75 },
+};
+
+
+int main(void)
+{
+    int failed = 0;
+    printf("%-18s %8s %8s %12s %12s %8s\n", "scenario", "trans", "bytes", "100kHz [us]", "400kHz [us]", "budget");
+    for (size_t i = 0; i < sizeof(si5351_benches) / sizeof(si5351_benches[0]); i++) {
+        const si5351_bench_t* bench = &(si5351_benches[i]);
+        si5351_t dev;
+        si5351_sim_t sim;
+        si5351_bus_t bus;
+        memset(&dev, 0, sizeof(si5351_t));
+        si5351_sim_open(&bus, &sim, SI5351_I2C_ADDR_0, SI5351_BENCH_XTAL, 0);
+        si5351_err_t result = bench->setup(&dev, &sim, &bus);
+        if (result == SI5351_OK) {
+            si5351_sim_reset_stats(&sim);
+            uint64_t start = sim.time_nsec;
+            result = bench->run(&dev, &sim, &bus);
+            // time spent in delay_msec() is added to the bus time at every rate
+            uint64_t delay = sim.time_nsec - start - si5351_sim_bus_nsec(&(sim.stats), sim.scl_hz);
+            bool over = SI5351_BENCH_BUDGETS && ((sim.stats.transactions > bench->transactions_max) || (sim.stats.bytes > bench->bytes_max));
+            printf("%-18s %8u %8u %12llu %12llu %8s\n", bench->name, sim.stats.transactions, sim.stats.bytes,
+                    (unsigned long long)((si5351_sim_bus_nsec(&(sim.stats), 100000) + delay) / 1000),
+                    (unsigned long long)((si5351_sim_bus_nsec(&(sim.stats), 400000) + delay) / 1000),
+                    over ? "OVER" : "ok");
+            if (over) {
+                printf("    budget: %u transactions, %u bytes\n", bench->transactions_max, bench->bytes_max);
+                failed++;
+            }
+        }
+        if (result != SI5351_OK) {
+            printf("%-18s failed: %d\n", bench->name, (int)result);
+            failed++;
+        }
+    }
+    return (failed == 0) ? 0 : 1;
+}
+
+si5351_err_t si5351_bench_setup_power_cycle(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)dev; (void)bus;
+    si5351_sim_power_cycle(sim);
+    return SI5351_OK;
+}
+
+si5351_err_t si5351_bench_setup_init(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)sim;
+    return si5351_dev_init(dev, bus, SI5351_VARIANT_A_B_GT, SI5351_I2C_ADDR_0, SI5351_CRYSTAL_FREQ_25MHZ, 0, false);
+}
+
+si5351_err_t si5351_bench_setup_bringup(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_init(dev, sim, bus), finish);
+    SI5351_GOTO_ON_ERROR(si5351_bench_bringup(dev, sim, bus), finish);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_setup_table(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_bringup(dev, sim, bus), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_build_table(dev, SI5351_MS_CLK0, SI5351_TABLE_MULTISYNTH, si5351_bench_tones,
+            sizeof(si5351_bench_tones) / sizeof(si5351_bench_tones[0]), si5351_bench_table), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_apply_table_entry(dev, &(si5351_bench_table[0])), finish);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_setup_step(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_bringup(dev, sim, bus), finish);
+    // CLK2 is the integer output of the bring-up, 10 Hz steps
+    SI5351_GOTO_ON_ERROR(si5351_dev_step_init(dev, &si5351_bench_step, SI5351_MS_CLK2, SI5351_BENCH_STEP_START, SI5351_BENCH_STEP_DELTA), finish);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_setup_vfo(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_bringup(dev, sim, bus), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_vfo_frequency(dev, SI5351_MS_CLK0, SI5351_PLLA, si5351_bench_tones[0]), finish);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_setup_fsk(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_vfo(dev, sim, bus), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_fsk_build_tones(dev, SI5351_MS_CLK0, si5351_bench_tones[0], SI5351_BENCH_WSPR_SPACING,
+            sizeof(si5351_bench_fsk_tones) / sizeof(si5351_bench_fsk_tones[0]), si5351_bench_fsk_tones), finish);
+    // any fixed pseudo random message will do
+    for (uint16_t i = 0; i < SI5351_BENCH_WSPR_SYMBOLS; i++) {
+        si5351_bench_symbols[i] = (uint8_t)((i * 37 + i / 5) % 4);
+    }
+    SI5351_GOTO_ON_ERROR(si5351_fsk_init(&si5351_bench_fsk, si5351_bench_fsk_tones, sizeof(si5351_bench_fsk_tones) / sizeof(si5351_bench_fsk_tones[0]),
+            si5351_bench_symbols, SI5351_BENCH_WSPR_SYMBOLS, SI5351_BENCH_WSPR_SYMBOL_nsec), finish);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_setup_stream(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_vfo(dev, sim, bus), finish);
+    // 500 Hz triangle, 2.5 kHz deviation
+    for (uint16_t i = 0; i < SI5351_BENCH_FM_SAMPLES; i++) {
+        int32_t phase = i % 16;
+        si5351_bench_fm_samples[i] = ((phase < 8) ? phase : 16 - phase) * (SI5351_BENCH_FM_DEVIATION / 4) - SI5351_BENCH_FM_DEVIATION;
+    }
+    SI5351_GOTO_ON_ERROR(si5351_stream_init(&si5351_bench_stream, si5351_bench_stream_buffer, SI5351_BENCH_FM_SAMPLES,
+            SI5351_BENCH_FM_RATE, sim->scl_hz, SI5351_STREAM_DECIMATE), finish);
+    SI5351_GOTO_ON_ERROR(si5351_stream_write(&si5351_bench_stream, si5351_bench_fm_samples, SI5351_BENCH_FM_SAMPLES, NULL), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_stream_start(dev, &si5351_bench_stream, SI5351_MS_CLK0, si5351_bench_tones[0]), finish);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_setup_event(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_bringup(dev, sim, bus), finish);
+    // the sticky bits of the bring-up go first, then PLLA loses its lock, PLLB is not used
+    si5351_sim_advance_usec(sim, sim->lock_time_usec);
+    SI5351_GOTO_ON_ERROR(si5351_dev_event_init(dev, &si5351_bench_events, &si5351_bench_event_handlers,
+            SI5351_EVENT_ALL & ~SI5351_EVENT_LOL_B), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_reset_single_pll(dev, SI5351_PLLA), finish);
+    si5351_bench_lol_seen = 0;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_setup_reset(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_bringup(dev, sim, bus), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_reset_single_pll(dev, SI5351_PLLA), finish);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_setup_brownout(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_bringup(dev, sim, bus), finish);
+    // the chip is back at its defaults and out of SYS_INIT
+    si5351_sim_power_cycle(sim);
+    si5351_sim_advance_usec(sim, SI5351_POWERUP_TIME_ms * 1000UL);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_setup_config(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_init(dev, sim, bus), finish);
+    si5351_bench_set_config(&si5351_bench_config, 4);
+    SI5351_GOTO_ON_ERROR(si5351_dev_apply(dev, &si5351_bench_config), finish);
+finish:
+    return result;
+}
+
+// the bring-up saved, then the chip is powered off and on
+si5351_err_t si5351_bench_setup_snapshot(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_bringup(dev, sim, bus), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_snapshot_export(dev, si5351_bench_snapshot, sizeof(si5351_bench_snapshot), NULL), finish);
+    si5351_sim_power_cycle(sim);
+finish:
+    return result;
+}
+
+// the bring-up with PLLB running at 700 MHz
+si5351_err_t si5351_bench_setup_pllb(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_bringup(dev, sim, bus), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_pll_vco(dev, SI5351_PLLB, 700000000), finish);
+finish:
+    return result;
+}
+
+// every output is powered down and silent
+si5351_err_t si5351_bench_cold_init(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_init(dev, sim, bus), finish);
+    for (uint8_t i = SI5351_MS_CLK0; i < SI5351_MS_CLK_COUNT; i++) {
+        if (si5351_sim_get_clk_frequency(sim, (si5351_ms_clk_reg_t)i) != 0) result = SI5351_ERR_FAIL;
+    }
+finish:
+    return result;
+}
+
+// the running outputs of the bring-up are kept
+si5351_err_t si5351_bench_unbreakable_init(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_init(dev, bus, SI5351_VARIANT_A_B_GT, SI5351_I2C_ADDR_0, SI5351_CRYSTAL_FREQ_25MHZ, 0, true), finish);
+    if (!si5351_bench_is_bringup_frequency(sim)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_set_pll_vco(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_pll_vco(dev, SI5351_PLLA, 700000000), finish);
+    if (!si5351_bench_is_frequency(si5351_sim_get_pll_frequency(sim, SI5351_PLLA), 700000000000ULL, SI5351_BENCH_CLK_TOLERANCE)) {
+        result = SI5351_ERR_FAIL;
+    }
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_set_multisynth(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_multisynth(dev, SI5351_MS_CLK0, SI5351_PLLA, 10000000), finish);
+    if (!si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK0, 10000000000ULL / 128)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_set_clk(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_clk(dev, SI5351_MS_CLK0, true, false, SI5351_CLK_SOURCE_MS_X, SI5351_CLK_R_DIVIDER_1, SI5351_DRIVE_STRENGTH_8mA), finish);
+    if (!si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK0, SI5351_BENCH_BRINGUP_CLK0 * 128)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_set_output_frequency(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    // one WSPR tone step on 20 m, millihertz
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_output_frequency(dev, SI5351_MS_CLK0, 14097101465ULL), finish);
+    if (!si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK0, 14097101465ULL)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_apply_table_entry(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_apply_table_entry(dev, &(si5351_bench_table[1])), finish);
+    if (!si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK0, si5351_bench_tones[1])) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_set_vfo_frequency(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_vfo_frequency(dev, SI5351_MS_CLK0, SI5351_PLLA, si5351_bench_tones[1]), finish);
+    if (!si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK0, si5351_bench_tones[1])) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_vfo_band_change(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    // 20 m to 160 m leaves the VCO range, a new divider and a reset of PLLA
+    si5351_err_t result;
+    uint32_t resets = sim->pll_resets[SI5351_PLLA];
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_vfo_frequency(dev, SI5351_MS_CLK0, SI5351_PLLA, SI5351_BENCH_VFO_LOW_BAND), finish);
+    if (sim->pll_resets[SI5351_PLLA] == resets) result = SI5351_ERR_FAIL;
+    if (!si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK0, SI5351_BENCH_VFO_LOW_BAND)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_set_pingpong_frequency(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    // CLK2 moves from PLLA to the idle PLLB, the same integer divider
+    si5351_err_t result;
+    si5351_bench_watch(bus, SI5351_MS_CLK2);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_pingpong_frequency(dev, SI5351_MS_CLK2, SI5351_BENCH_STEP_START + SI5351_BENCH_STEP_DELTA), finish);
+    if (!si5351_bench_watched_in_range) result = SI5351_ERR_FAIL;
+    if (!si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK2, SI5351_BENCH_STEP_START + SI5351_BENCH_STEP_DELTA)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_pingpong_new_divider(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    // the fractional CLK0 gets an even divider and R on PLLB, written before the switch,
+    // in between PLLA drives the new divider
+    si5351_err_t result;
+    si5351_bench_watch(bus, SI5351_MS_CLK0);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_pingpong_frequency(dev, SI5351_MS_CLK0, SI5351_BENCH_SWEEP_START * 1000ULL), finish);
+    if (!si5351_bench_watched_in_range) result = SI5351_ERR_FAIL;
+    if (!si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK0, SI5351_BENCH_SWEEP_START * 1000ULL)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+// the sequence of examples/si5351a-espidf/main/si5351a-test.c
+si5351_err_t si5351_bench_bringup(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_powerdown(dev), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_pll_source(dev, SI5351_PLL_XTAL, SI5351_PLL_XTAL, SI5351_CLKIN_DIVIDER1), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_pll_vco(dev, SI5351_PLLA, 600000000), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_fanout(dev, false, false, true), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_multisynth(dev, SI5351_MS_CLK0, SI5351_PLLA, 339200), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_multisynth_integer(dev, SI5351_MS_CLK2, SI5351_PLLA, 4), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_clk(dev, SI5351_MS_CLK0, true, false, SI5351_CLK_SOURCE_MS_X, SI5351_CLK_R_DIVIDER_128, SI5351_DRIVE_STRENGTH_2mA), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_clk(dev, SI5351_MS_CLK1, true, true, SI5351_CLK_SOURCE_MS_0_OR_4, SI5351_CLK_R_DIVIDER_128, SI5351_DRIVE_STRENGTH_2mA), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_clk(dev, SI5351_MS_CLK2, true, false, SI5351_CLK_SOURCE_MS_X, SI5351_CLK_R_DIVIDER_64, SI5351_DRIVE_STRENGTH_2mA), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_reset_pll(dev), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_output_enable(dev, SI5351_MS_CLK0, true), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_output_enable(dev, SI5351_MS_CLK1, true), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_output_enable(dev, SI5351_MS_CLK2, true), finish);
+    if (!si5351_bench_is_bringup_frequency(sim)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+// the outputs of the bring-up off and on again
+si5351_err_t si5351_bench_group_toggle(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_output_enable_mask(dev, SI5351_BENCH_GROUP, false), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_clk_power_mask(dev, SI5351_BENCH_GROUP, false), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_clk_power_mask(dev, SI5351_BENCH_GROUP, true), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_output_enable_mask(dev, SI5351_BENCH_GROUP, true), finish);
+    if (!si5351_bench_is_bringup_frequency(sim)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+// the fractional CLK0 and the integer CLK2 moved to PLLB by their control registers
+si5351_err_t si5351_bench_clk_controls(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    uint8_t controls[SI5351_MS_CLK_COUNT];
+    memcpy(controls, &(sim->regs[SI5351_CLK0_CONTROL]), sizeof(controls));
+    controls[SI5351_MS_CLK0] |= SI5351_CLK_CONTROL_MS_SRC_bm;
+    controls[SI5351_MS_CLK2] |= SI5351_CLK_CONTROL_MS_SRC_bm;
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_clk_controls(dev, controls), finish);
+    for (uint8_t i = SI5351_MS_CLK0; i <= SI5351_MS_CLK2; i += 2) {
+        double frequency = si5351_sim_get_ms_frequency(sim, (si5351_ms_clk_reg_t)i);
+        if ((dev->ms[i].pll != SI5351_PLLB) || !dev->ms[i].configured) result = SI5351_ERR_FAIL;
+        if ((frequency - dev->ms[i].frequency > 1) || (dev->ms[i].frequency - frequency > 1)) result = SI5351_ERR_FAIL;
+    }
+finish:
+    return result;
+}
+
+// every step of the multisynth is checked
+si5351_err_t si5351_bench_retune_sweep(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result = SI5351_OK;
+    for (uint32_t i = 0; i < SI5351_BENCH_SWEEP_STEPS; i++) {
+        uint32_t frequency = SI5351_BENCH_SWEEP_START + i * SI5351_BENCH_SWEEP_STEP;
+        SI5351_GOTO_ON_ERROR(si5351_dev_set_multisynth(dev, SI5351_MS_CLK0, SI5351_PLLA, frequency), finish);
+        if (!si5351_bench_is_frequency(si5351_sim_get_ms_frequency(sim, SI5351_MS_CLK0), frequency * 1000ULL, SI5351_BENCH_CLK_TOLERANCE)) {
+            result = SI5351_ERR_FAIL;
+        }
+    }
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_step_sweep(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result = SI5351_OK;
+    for (uint32_t i = 0; i < SI5351_BENCH_SWEEP_STEPS; i++) {
+        SI5351_GOTO_ON_ERROR(si5351_dev_step(dev, &si5351_bench_step), finish);
+    }
+    if (!si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK2, SI5351_BENCH_STEP_START + SI5351_BENCH_SWEEP_STEPS * SI5351_BENCH_STEP_DELTA)) {
+        result = SI5351_ERR_FAIL;
+    }
+finish:
+    return result;
+}
+
+// one WSPR transmission, 162 symbols of 683 ms, ending on the tone of the last symbol
+si5351_err_t si5351_bench_fsk_wspr(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_fsk_run(dev, &si5351_bench_fsk), finish);
+    uint64_t tone = si5351_bench_tones[si5351_bench_symbols[SI5351_BENCH_WSPR_SYMBOLS - 1]];
+    if (!si5351_bench_is_frequency(si5351_sim_get_clk_frequency(sim, SI5351_MS_CLK0), tone, SI5351_BENCH_WSPR_SPACING / 10)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+// 1000 samples at 8 kHz, decimated to what the bus keeps up with, ending within the deviation
+si5351_err_t si5351_bench_stream_fm(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result = SI5351_OK;
+    while (si5351_bench_stream.tail != si5351_bench_stream.head) {
+        SI5351_GOTO_ON_ERROR(si5351_dev_stream_service(dev, &si5351_bench_stream), finish);
+    }
+    if (!si5351_bench_is_frequency(si5351_sim_get_clk_frequency(sim, SI5351_MS_CLK0), si5351_bench_tones[0], SI5351_BENCH_FM_DEVIATION)) {
+        result = SI5351_ERR_FAIL;
+    }
+finish:
+    return result;
+}
+
+// the INTR pin of the simulator stands in for the pin interrupt
+si5351_err_t si5351_bench_event_lol(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    if (si5351_sim_get_intr(sim)) si5351_event_isr(&si5351_bench_events);
+    SI5351_GOTO_ON_ERROR(si5351_dev_event_service(dev, &si5351_bench_events), finish);
+    if (si5351_bench_lol_seen != (1 << SI5351_PLLA)) result = SI5351_ERR_FAIL;
+    // the serviced sticky bit is cleared
+    if (sim->regs[SI5351_INTERRUPT_STATUS_STICKY] & SI5351_DEVICE_STATUS_LOL_A_bm) result = SI5351_ERR_FAIL;
+    if (!si5351_bench_is_bringup_frequency(sim)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+void si5351_bench_loss_of_lock(void* ctx, si5351_pll_reg_t pll, bool active)
+{
+    (void)active;
+    *(uint8_t*)ctx |= (uint8_t)(1 << pll);
+}
+
+// the status polls from a PLL reset to its lock
+si5351_err_t si5351_bench_wait_lock(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_wait_lock(dev, 1 << SI5351_PLLA, SI5351_PLL_LOCK_TIME_ms * 1000UL, NULL), finish);
+    if (!si5351_bench_is_bringup_frequency(sim)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+// a healthy chip is left alone, one back at its defaults gets the bring-up again
+si5351_err_t si5351_bench_watchdog_check(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_watchdog_check(dev, &si5351_bench_watchdog, false), finish);
+    if (!si5351_bench_is_bringup_frequency(sim)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+// the bring-up above as one desired state
+si5351_err_t si5351_bench_config_apply(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    si5351_bench_set_config(&si5351_bench_config, 4);
+    SI5351_GOTO_ON_ERROR(si5351_dev_apply(dev, &si5351_bench_config), finish);
+    if (!si5351_bench_is_bringup_frequency(sim)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+// the same state with another CLK2 divider, only its multisynth changes
+si5351_err_t si5351_bench_profile_switch(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    si5351_bench_set_config(&si5351_bench_config, 6);
+    SI5351_GOTO_ON_ERROR(si5351_dev_apply(dev, &si5351_bench_config), finish);
+    if (!si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK2, 1562500000ULL)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+// the same state with a CLK2 phase offset, PLLA is reset for it to take effect
+si5351_err_t si5351_bench_phase_apply(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    uint32_t resets = sim->pll_resets[SI5351_PLLA];
+    si5351_bench_set_config(&si5351_bench_config, 4);
+    si5351_bench_config.clk[SI5351_MS_CLK2].phase = 4;
+    SI5351_GOTO_ON_ERROR(si5351_dev_apply(dev, &si5351_bench_config), finish);
+    if (sim->pll_resets[SI5351_PLLA] == resets) result = SI5351_ERR_FAIL;
+    if (!si5351_bench_is_bringup_frequency(sim)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+// a new PLLA with a CLK2 divider out of range, the apply fails and the chip keeps running as it was
+si5351_err_t si5351_bench_config_reject(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    uint8_t regs[SI5351_SIM_REGISTER_COUNT];
+    uint32_t resets = sim->pll_resets[SI5351_PLLA];
+    uint32_t frequency = dev->ms[SI5351_MS_CLK2].frequency;
+    memcpy(regs, sim->regs, sizeof(regs));
+    si5351_bench_set_config(&si5351_bench_config, 3);
+    si5351_bench_config.plan.pll[SI5351_PLLA] = (si5351_plan_pll_t){ .frequency = 800000000, .a = 32, .b = 0, .c = 1 };
+    if (si5351_dev_apply(dev, &si5351_bench_config) == SI5351_OK) return SI5351_ERR_FAIL;
+    if (memcmp(regs, sim->regs, sizeof(regs)) != 0) return SI5351_ERR_FAIL;
+    if (sim->pll_resets[SI5351_PLLA] != resets) return SI5351_ERR_FAIL;
+    if (dev->ms[SI5351_MS_CLK2].frequency != frequency) return SI5351_ERR_FAIL;
+    // the dropped registers are unknown to the shadow, the next apply sends them again
+    si5351_bench_set_config(&si5351_bench_config, 4);
+    if (si5351_dev_apply(dev, &si5351_bench_config) != SI5351_OK) return SI5351_ERR_FAIL;
+    return si5351_bench_is_bringup_frequency(sim) ? SI5351_OK : SI5351_ERR_FAIL;
+}
+
+// PLLA at 600 MHz, CLK0 and the inverted CLK1 from MS0 at 2650 Hz, CLK2 at 600 MHz / clk2_divider / 64
+void si5351_bench_set_config(si5351_config_t* config, uint16_t clk2_divider)
+{
+    memset(config, 0, sizeof(si5351_config_t));
+    config->crystal_load = SI5351_CRYSTAL_LOAD_10PF;
+    config->fanout_ms = true;
+    config->plan.pll[SI5351_PLLA] = (si5351_plan_pll_t){ .frequency = 600000000, .a = 24, .b = 0, .c = 1 };
+    config->plan.clk[SI5351_MS_CLK0] = (si5351_plan_clk_t){ .used = true, .pll = SI5351_PLLA, .a = 1768, .b = 46, .c = 53, .r_div = SI5351_CLK_R_DIVIDER_128 };
+    config->plan.clk[SI5351_MS_CLK1].r_div = SI5351_CLK_R_DIVIDER_128;
+    config->plan.clk[SI5351_MS_CLK2] = (si5351_plan_clk_t){ .used = true, .pll = SI5351_PLLA, .a = clk2_divider, .b = 0, .c = 1, .r_div = SI5351_CLK_R_DIVIDER_64 };
+    for (uint8_t i = SI5351_MS_CLK0; i <= SI5351_MS_CLK2; i++) {
+        config->clk[i] = (si5351_config_clk_t){ .powerup = true, .enabled = true, .source = SI5351_CLK_SOURCE_MS_X, .drive = SI5351_DRIVE_STRENGTH_2mA };
+    }
+    config->clk[SI5351_MS_CLK1].source = SI5351_CLK_SOURCE_MS_0_OR_4;
+    config->clk[SI5351_MS_CLK1].inverted = true;
+}
+
+// cold boot to valid clocks from a snapshot, against cold_init and bringup
+si5351_err_t si5351_bench_snapshot_boot(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_bench_setup_init(dev, sim, bus), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_snapshot_import(dev, si5351_bench_snapshot, sizeof(si5351_bench_snapshot)), finish);
+    if (!si5351_bench_is_bringup_frequency(sim)) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_bench_plan_apply(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    return si5351_bench_plan_targets_apply(dev, sim, si5351_bench_plan_targets,
+            sizeof(si5351_bench_plan_targets) / sizeof(si5351_bench_plan_targets[0]));
+}
+
+// a hard and a fractional output against the VCO cap of the last free PLL
+si5351_err_t si5351_bench_plan_capped(si5351_t* dev, si5351_sim_t* sim, si5351_bus_t* bus)
+{
+    (void)bus;
+    si5351_err_t result;
+    uint8_t count = sizeof(si5351_bench_plan_capped_targets) / sizeof(si5351_bench_plan_capped_targets[0]);
+    SI5351_GOTO_ON_ERROR(si5351_bench_plan_targets_apply(dev, sim, si5351_bench_plan_capped_targets, count), finish);
+    if ((si5351_bench_plan.clk[SI5351_MS_CLK1].pll != SI5351_PLLA) || (si5351_bench_plan.clk[SI5351_MS_CLK1].b == 0)) result = SI5351_ERR_FAIL;
+    if ((si5351_bench_plan.clk[SI5351_MS_CLK2].pll != SI5351_PLLB) || (si5351_bench_plan.pll[SI5351_PLLB].frequency > 2650UL * 128 * 2048)) {
+        result = SI5351_ERR_FAIL;
+    }
+finish:
+    return result;
+}
+
+// planned and written, then the outputs are powered up and enabled
+si5351_err_t si5351_bench_plan_targets_apply(si5351_t* dev, si5351_sim_t* sim, const si5351_plan_target_t* targets, uint8_t count)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_plan(dev, targets, count, NULL, &si5351_bench_plan), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_plan(dev, &si5351_bench_plan), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_clk_power_mask(dev, SI5351_BENCH_GROUP, true), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_output_enable_mask(dev, SI5351_BENCH_GROUP, true), finish);
+    for (uint8_t i = 0; i < count; i++) {
+        if (!si5351_bench_is_clk_frequency(sim, targets[i].clk, (uint64_t)targets[i].frequency * 1000)) result = SI5351_ERR_FAIL;
+    }
+finish:
+    return result;
+}
+
+// frequency in mHz
+bool si5351_bench_is_clk_frequency(si5351_sim_t* sim, si5351_ms_clk_reg_t clk, uint64_t frequency)
+{
+    return si5351_bench_is_frequency(si5351_sim_get_clk_frequency(sim, clk), frequency, SI5351_BENCH_CLK_TOLERANCE);
+}
+
+bool si5351_bench_is_bringup_frequency(si5351_sim_t* sim)
+{
+    return si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK0, SI5351_BENCH_BRINGUP_CLK0)
+            && si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK1, SI5351_BENCH_BRINGUP_CLK0)
+            && si5351_bench_is_clk_frequency(sim, SI5351_MS_CLK2, SI5351_BENCH_BRINGUP_CLK2);
+}
+
+// frequency in Hz against expected and tolerance in mHz
+bool si5351_bench_is_frequency(double frequency, uint64_t expected, uint64_t tolerance)
+{
+    double error = frequency * 1000 - (double)expected;
+    return (error < (double)tolerance) && (error > -(double)tolerance);
+}
+
+// every write of the driver is followed by a range check of clk on the simulator
+void si5351_bench_watch(si5351_bus_t* bus, si5351_ms_clk_reg_t clk)
+{
+    si5351_bench_watched_bus = *bus;
+    si5351_bench_watched_clk = clk;
+    si5351_bench_watched_in_range = true;
+    bus->write = si5351_bench_watch_write;
+    bus->write_bursts = si5351_bench_watch_write_bursts;
+}
+
+si5351_err_t si5351_bench_watch_write(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    si5351_err_t result = si5351_bench_watched_bus.write(ctx, i2c_addr, reg, data, count);
+    si5351_bench_watch_check((si5351_sim_t*)ctx);
+    return result;
+}
+
+si5351_err_t si5351_bench_watch_write_bursts(void* ctx, uint8_t i2c_addr, si5351_burst_t* bursts, uint8_t count)
+{
+    si5351_err_t result = si5351_bench_watched_bus.write_bursts(ctx, i2c_addr, bursts, count);
+    si5351_bench_watch_check((si5351_sim_t*)ctx);
+    return result;
+}
+
+// the multisynth and the output stay within the limits of the chip
+void si5351_bench_watch_check(si5351_sim_t* sim)
+{
+    double ms = si5351_sim_get_ms_frequency(sim, si5351_bench_watched_clk);
+    double clk = si5351_sim_get_clk_frequency(sim, si5351_bench_watched_clk);
+    if ((ms > SI5351_REVB_MULTISYNTH_FREQUENCY_MAX) || (clk > SI5351_REVB_MULTISYNTH_FREQUENCY_MAX)
+            || (clk < SI5351_REVB_MULTISYNTH_FREQUENCY_MIN)) {
+        si5351_bench_watched_in_range = false;
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * si5351_constexpr_check.cpp
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351.h"
+#include "si5351_table.h"
+#include "si5351_sim.h"
+#include "si5351_constexpr.h"
+#include <stdio.h>
+#include <string.h>
+
+
+// The entries of si5351_constexpr.h against si5351_dev_build_table() for the
+// same PLL and outputs, burst and achieved frequency have to be identical.
+
+
+// function prototype
+bool si5351_constexpr_check(const char* name, si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_table_mode_t mode,
+                            uint64_t frequency, const si5351_table_entry_t* expected);
+
+
+#define SI5351_CONSTEXPR_XTAL           25000000UL
+#define SI5351_CONSTEXPR_DIVIDER        72
+// 72 times 9876543 Hz, a fractional feedback divider from the crystal
+#define SI5351_CONSTEXPR_VCO            711111096UL
+
+
+typedef si5351_pll_entry<SI5351_PLLA, SI5351_CONSTEXPR_XTAL, SI5351_CONSTEXPR_VCO> si5351_constexpr_pll;
+
+
+int main(void)
+{
+    int failed = 0;
+    si5351_t dev;
+    si5351_sim_t sim;
+    si5351_bus_t bus;
+    memset(&dev, 0, sizeof(si5351_t));
+    si5351_sim_open(&bus, &sim, SI5351_I2C_ADDR_0, SI5351_CONSTEXPR_XTAL, 0);
+    si5351_err_t result = si5351_dev_init(&dev, &bus, SI5351_VARIANT_A_B_GT, SI5351_I2C_ADDR_0, SI5351_CRYSTAL_FREQ_25MHZ, 0, false);
+    if (result == SI5351_OK) result = si5351_dev_set_pll_vco(&dev, SI5351_PLLA, 700000000);
+    if (result == SI5351_OK) result = si5351_dev_set_multisynth_integer(&dev, SI5351_MS_CLK0, SI5351_PLLA, SI5351_CONSTEXPR_DIVIDER);
+    if (result == SI5351_OK) result = si5351_dev_set_multisynth_integer(&dev, SI5351_MS_CLK6, SI5351_PLLA, SI5351_CONSTEXPR_DIVIDER);
+    if (result != SI5351_OK) {
+        printf("setup failed: %d\n", (int)result);
+        return 1;
+    }
+    if (!si5351_constexpr_check("pll", &dev, SI5351_MS_CLK0, SI5351_TABLE_PLL,
+            (uint64_t)SI5351_CONSTEXPR_VCO * 1000 / SI5351_CONSTEXPR_DIVIDER, &si5351_constexpr_pll::entry)) failed++;
+    // the multisynth entries run from the VCO of the PLL entry
+    result = si5351_dev_apply_table_entry(&dev, &si5351_constexpr_pll::entry);
+    if (result != SI5351_OK) {
+        printf("pll apply failed: %d\n", (int)result);
+        return 1;
+    }
+    if (!si5351_constexpr_check("ms_integer", &dev, SI5351_MS_CLK0, SI5351_TABLE_MULTISYNTH, 10000000000ULL,
+            &si5351_multisynth_entry<SI5351_MS_CLK0, si5351_constexpr_pll, 10000000>::entry)) failed++;
+    if (!si5351_constexpr_check("ms_fractional", &dev, SI5351_MS_CLK0, SI5351_TABLE_MULTISYNTH, 14097100000ULL,
+            &si5351_multisynth_entry<SI5351_MS_CLK0, si5351_constexpr_pll, 14097100>::entry)) failed++;
+    if (!si5351_constexpr_check("ms_r_divider", &dev, SI5351_MS_CLK0, SI5351_TABLE_MULTISYNTH, 100000000ULL,
+            &si5351_multisynth_entry<SI5351_MS_CLK0, si5351_constexpr_pll, 100000, SI5351_CLK_R_DIVIDER_4>::entry)) failed++;
+    if (!si5351_constexpr_check("ms6_even", &dev, SI5351_MS_CLK6, SI5351_TABLE_MULTISYNTH, 10000000000ULL,
+            &si5351_multisynth_entry<SI5351_MS_CLK6, si5351_constexpr_pll, 10000000>::entry)) failed++;
+    return (failed == 0) ? 0 : 1;
+}
+
+// frequency in mHz, as for si5351_dev_build_table()
+bool si5351_constexpr_check(const char* name, si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_table_mode_t mode,
+                            uint64_t frequency, const si5351_table_entry_t* expected)
+{
+    si5351_table_entry_t built;
+    si5351_err_t result = si5351_dev_build_table(dev, clk, mode, &frequency, 1, &built);
+    if (result != SI5351_OK) {
+        printf("%-18s failed: %d\n", name, (int)result);
+        return false;
+    }
+    bool same = (built.mode == expected->mode) && (built.index == expected->index) && (built.reg == expected->reg)
+            && (built.count == expected->count) && (memcmp(built.data, expected->data, built.count) == 0)
+            && (built.frequency == expected->frequency) && (built.error == expected->error);
+    printf("%-18s %10lu Hz %+6ld mHz %8s\n", name, (unsigned long)expected->frequency, (long)expected->error, same ? "ok" : "DIFFERS");
+    if (!same) {
+        printf("    built: %lu Hz %+ld mHz, data", (unsigned long)built.frequency, (long)built.error);
+        for (uint8_t i = 0; i < built.count; i++) printf(" %02X", built.data[i]);
+        printf("\n    expected data");
+        for (uint8_t i = 0; i < expected->count; i++) printf(" %02X", expected->data[i]);
+        printf("\n");
+    }
+    return same;
+}
@@ -0,0 +1,190 @@
+/*
+ * si5351_cycles.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351.h"
+#include "si5351_table.h"
+#include "si5351_step.h"
+#include <string.h>
+
+
+// CPU cost of a retune, the bus is a stub that accepts everything. Every
+// scenario hashes the registers and errors it produced, the hash has to match
+// the reference below so both division backends stay bit-exact.
+// CMake builds it twice, si5351_cycles and si5351_cycles_soft
+// (SI5351_USE_SOFT_DIVISION=1).
+typedef struct {
+    const char* name;
+    si5351_err_t (*setup)(si5351_t* dev);
+    void (*run)(si5351_t* dev, uint32_t i);
+    uint32_t hash;
+} si5351_cycles_t;
+
+
+// function prototype
+si5351_err_t si5351_cycles_read(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count);
+si5351_err_t si5351_cycles_write(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count);
+void si5351_cycles_delay_msec(void* ctx, uint32_t msec);
+void si5351_cycles_set_pll_vco(si5351_t* dev, uint32_t i);
+void si5351_cycles_set_multisynth(si5351_t* dev, uint32_t i);
+void si5351_cycles_set_output_frequency(si5351_t* dev, uint32_t i);
+void si5351_cycles_apply_table_entry(si5351_t* dev, uint32_t i);
+si5351_err_t si5351_cycles_setup_step(si5351_t* dev);
+void si5351_cycles_step(si5351_t* dev, uint32_t i);
+uint32_t si5351_cycles_hash(uint32_t hash, const void* data, size_t count);
+void si5351_cycles_timer_start(void);
+uint64_t si5351_cycles_timer_stop(void);
+
+
+#define SI5351_CYCLES_XTAL              25000000UL
+#define SI5351_CYCLES_STEPS             200
+#define SI5351_CYCLES_HASH_SEED         2166136261UL
+
+const si5351_bus_t si5351_cycles_bus = {
+    .read = si5351_cycles_read,
+    .write = si5351_cycles_write,
+    .write_bursts = NULL,
+    .delay_msec = si5351_cycles_delay_msec,
+    .get_time_usec = NULL,
+    .ctx = NULL,
+};
+
+const si5351_cycles_t si5351_cycles[] = {
+    { "set_pll_vco",        NULL,                       si5351_cycles_set_pll_vco,              0x6B19A5D6UL },
+    { "set_multisynth",     NULL,                       si5351_cycles_set_multisynth,           0x573106C6UL },
+    { "set_output_freq",    NULL,                       si5351_cycles_set_output_frequency,     0x1B10DED5UL },
+    { "table_apply",        NULL,                       si5351_cycles_apply_table_entry,        0x1B10DED5UL },
+    { "step",               si5351_cycles_setup_step,   si5351_cycles_step,                     0x67474A7DUL },
+};
+
+si5351_table_entry_t si5351_cycles_table[SI5351_CYCLES_STEPS];
+si5351_step_t si5351_cycles_step_context;
+
+
+#include <time.h>
+
+struct timespec si5351_cycles_start;
+
+void si5351_cycles_timer_start(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &si5351_cycles_start);
+}
+
+// nanoseconds
+uint64_t si5351_cycles_timer_stop(void)
+{
+    struct timespec stop;
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    return (uint64_t)(stop.tv_sec - si5351_cycles_start.tv_sec) * 1000000000ULL + stop.tv_nsec - si5351_cycles_start.tv_nsec;
+}
+
+
+int main(void)
+{
+    int failed = 0;
+    printf("soft division %d, ns per call\n", SI5351_USE_SOFT_DIVISION);
+    for (size_t i = 0; i < sizeof(si5351_cycles) / sizeof(si5351_cycles[0]); i++) {
+        const si5351_cycles_t* scenario = &(si5351_cycles[i]);
+        si5351_t dev;
+        si5351_err_t result = si5351_dev_init(&dev, &si5351_cycles_bus, SI5351_VARIANT_A_B_GT, SI5351_I2C_ADDR_0, SI5351_CRYSTAL_FREQ_25MHZ, 0, false);
+        if (result == SI5351_OK) result = si5351_dev_set_pll_vco(&dev, SI5351_PLLA, 887654321);
+        if (result == SI5351_OK) result = si5351_dev_set_multisynth(&dev, SI5351_MS_CLK0, SI5351_PLLA, 10000000);
+        // one entry at a time, no frequency list on the stack
+        for (uint32_t step = 0; (step < SI5351_CYCLES_STEPS) && (result == SI5351_OK); step++) {
+            uint64_t frequency = 14097100000ULL + step * 1465ULL;
+            result = si5351_dev_build_table(&dev, SI5351_MS_CLK0, SI5351_TABLE_MULTISYNTH, &frequency, 1, &(si5351_cycles_table[step]));
+        }
+        if ((result == SI5351_OK) && (scenario->setup != NULL)) result = scenario->setup(&dev);
+        if (result != SI5351_OK) {
+            printf("%-18s failed: %d\n", scenario->name, (int)result);
+            failed++;
+            continue;
+        }
+        uint64_t total = 0;
+        uint32_t hash = SI5351_CYCLES_HASH_SEED;
+        for (uint32_t step = 0; step < SI5351_CYCLES_STEPS; step++) {
+            si5351_cycles_timer_start();
+            scenario->run(&dev, step);
+            total += si5351_cycles_timer_stop();
+            hash = si5351_cycles_hash(hash, &(dev.regs[SI5351_MULTISYNTH_NA_PARAMETERS]),
+                    SI5351_MULTISYNTH0_PARAMETERS + SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH - SI5351_MULTISYNTH_NA_PARAMETERS);
+            hash = si5351_cycles_hash(hash, &(dev.pll[SI5351_PLLA].error), sizeof(int32_t));
+            hash = si5351_cycles_hash(hash, &(dev.ms[SI5351_MS_CLK0].error), sizeof(int32_t));
+        }
+        bool match = (hash == scenario->hash);
+        printf("%-18s %10lu   hash %08lx %s\n", scenario->name, (unsigned long)(total / SI5351_CYCLES_STEPS), (unsigned long)hash, match ? "ok" : "MISMATCH");
+        if (!match) failed++;
+    }
+    return (failed == 0) ? 0 : 1;
+}
+
+si5351_err_t si5351_cycles_read(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    (void)ctx; (void)i2c_addr; (void)reg;
+    memset(data, 0, count);
+    return SI5351_OK;
+}
+
+si5351_err_t si5351_cycles_write(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    (void)ctx; (void)i2c_addr; (void)reg; (void)data; (void)count;
+    return SI5351_OK;
+}
+
+void si5351_cycles_delay_msec(void* ctx, uint32_t msec)
+{
+    (void)ctx; (void)msec;
+}
+
+void si5351_cycles_set_pll_vco(si5351_t* dev, uint32_t i)
+{
+    si5351_dev_set_pll_vco(dev, SI5351_PLLA, 600000000UL + i * 1171875UL + i * i * 7UL);
+}
+
+void si5351_cycles_set_multisynth(si5351_t* dev, uint32_t i)
+{
+    si5351_dev_set_multisynth(dev, SI5351_MS_CLK0, SI5351_PLLA, 7000000UL + i * 9973UL);
+}
+
+void si5351_cycles_set_output_frequency(si5351_t* dev, uint32_t i)
+{
+    si5351_dev_set_output_frequency(dev, SI5351_MS_CLK0, 14097100000ULL + i * 1465ULL);
+}
+
+void si5351_cycles_apply_table_entry(si5351_t* dev, uint32_t i)
+{
+    si5351_dev_apply_table_entry(dev, &(si5351_cycles_table[i]));
+}
+
+// CLK2 integer on PLLB, the same tone steps as set_output_freq
+si5351_err_t si5351_cycles_setup_step(si5351_t* dev)
+{
+    si5351_err_t result = si5351_dev_set_pll_vco(dev, SI5351_PLLB, 700000000UL);
+    if (result == SI5351_OK) result = si5351_dev_set_multisynth_integer(dev, SI5351_MS_CLK2, SI5351_PLLB, 50);
+    if (result == SI5351_OK) result = si5351_dev_step_init(dev, &si5351_cycles_step_context, SI5351_MS_CLK2, 14097100000ULL, 1465);
+    return result;
+}
+
+void si5351_cycles_step(si5351_t* dev, uint32_t i)
+{
+    (void)i;
+    si5351_dev_step(dev, &si5351_cycles_step_context);
+}
+
+// FNV-1a
+uint32_t si5351_cycles_hash(uint32_t hash, const void* data, size_t count)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < count; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
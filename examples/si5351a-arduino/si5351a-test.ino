@@ -33,7 +33,7 @@ void setup() {
     Serial.begin(115200);
     i2c_master_init();
     // Initialization
-    err = si5351_init(SI5351_VARIANT_A_B_GT, SI5351_I2C_ADDR_0, SI5351_CRYSTAL_FREQ_25MHZ, 0, false);
+    err = si5351_init(&si5351_bus_arduino, SI5351_VARIANT_A_B_GT, SI5351_I2C_ADDR_0, SI5351_CRYSTAL_FREQ_25MHZ, 0, false);
     if (err != SI5351_OK) sprintf(buffer, "Init failed: error code(%i)", (int)err);
     Serial.println(buffer);
     // Status check before configuration
@@ -42,7 +42,7 @@ void app_main(void)
 {
     i2c_master_init();
     // Initialization
-    err = si5351_init(SI5351_VARIANT_A_B_GT, SI5351_I2C_ADDR_0, SI5351_CRYSTAL_FREQ_25MHZ, 0, false);
+    err = si5351_init(&si5351_bus_espidf, SI5351_VARIANT_A_B_GT, SI5351_I2C_ADDR_0, SI5351_CRYSTAL_FREQ_25MHZ, 0, false);
     if (err != SI5351_OK) ESP_LOGE(TAG, "Init failed: %s", esp_err_to_name(err));
     // Status check before configuration
     err = si5351_get_status(&status);
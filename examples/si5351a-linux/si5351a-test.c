@@ -0,0 +1,107 @@
+/*
+ * s5351a-test.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include <stdio.h>
+#include "si5351.h"
+#include "si5351_linux.h"
+
+
+// function prototype
+void show_chip_status(uint8_t status);
+
+/* Test setup
+ * ---------------------
+ * SI5351A-B-GT
+ * XTAL:  25MHz
+ * Channel 0: 2650 Hz
+ * Channel 1: 2650 Hz Inverted
+ * Channel 2: 2343.75 kHz
+ */
+
+si5351_bus_t bus;
+si5351_linux_t i2c;
+si5351_err_t err;
+uint8_t status;
+
+int main(int argc, char* argv[])
+{
+    const char* path = (argc > 1) ? argv[1] : "/dev/i2c-1";
+    err = si5351_linux_open(&bus, &i2c, path);
+    if (err != SI5351_OK) {
+        printf("Cannot open %s\n", path);
+        return 1;
+    }
+    // Initialization
+    err = si5351_init(&bus, SI5351_VARIANT_A_B_GT, SI5351_I2C_ADDR_0, SI5351_CRYSTAL_FREQ_25MHZ, 0, false);
+    if (err != SI5351_OK) printf("Init failed: error code(%i)\n", (int)err);
+    // Status check before configuration
+    err = si5351_get_status(&status);
+    if (err == SI5351_OK) {
+        show_chip_status(status);
+    } else {
+        printf("Status failed: error code(%i)\n", (int)err);
+    }
+    printf("\n");
+
+    // Disable output
+    // Power down output driver
+    si5351_set_powerdown();
+    // Write new configuration in one transaction, the commit is a single I2C_RDWR ioctl
+    // The order of register configuration is important, go with the flow
+    si5351_begin();
+    si5351_set_pll_source(SI5351_PLL_XTAL, SI5351_PLL_XTAL, SI5351_CLKIN_DIVIDER1);
+    si5351_set_pll_vco(SI5351_PLLA, 600000000);
+    // Configuring the multisynth stage
+    si5351_set_fanout(false, false, true);
+    si5351_set_multisynth(SI5351_MS_CLK0, SI5351_PLLA, 339200);
+    si5351_set_multisynth_integer(SI5351_MS_CLK2, SI5351_PLLA, 4);
+    // Any unused clock outputs should be powered down
+    si5351_set_clk(SI5351_MS_CLK0, true, false, SI5351_CLK_SOURCE_MS_X, SI5351_CLK_R_DIVIDER_128, SI5351_DRIVE_STRENGTH_2mA);
+    si5351_set_clk(SI5351_MS_CLK1, true, true, SI5351_CLK_SOURCE_MS_0_OR_4, SI5351_CLK_R_DIVIDER_128, SI5351_DRIVE_STRENGTH_2mA);
+    si5351_set_clk(SI5351_MS_CLK2, true, false, SI5351_CLK_SOURCE_MS_X, SI5351_CLK_R_DIVIDER_64, SI5351_DRIVE_STRENGTH_2mA);
+    err = si5351_commit();
+    if (err != SI5351_OK) printf("Configuration failed: error code(%i)\n", (int)err);
+    // Apply PLLA and PLLB soft reset
+    si5351_reset_pll();
+    // Enable the outputs once PLLA is locked
+    uint32_t lock_usec;
+    err = si5351_wait_lock(1 << SI5351_PLLA, 10000, &lock_usec);
+    if (err == SI5351_OK) {
+        printf("PLLA locked in %u us\n", (unsigned)lock_usec);
+    } else {
+        printf("PLLA lock failed: error code(%i)\n", (int)err);
+    }
+    // Enable desired outputs
+    si5351_set_output_enable(SI5351_MS_CLK0, true);
+    si5351_set_output_enable(SI5351_MS_CLK1, true);
+    si5351_set_output_enable(SI5351_MS_CLK2, true);
+
+    // Status check
+    err = si5351_get_status(&status);
+    if (err == SI5351_OK) {
+        show_chip_status(status);
+    } else {
+        printf("Status failed: error code(%i)\n", (int)err);
+    }
+    si5351_linux_close(&i2c);
+    return 0;
+}
+
+void show_chip_status(uint8_t status)
+{
+    printf("Si5351 DEVICE STATUS \n");
+    printf("    SYS_INIT  : %s \n", (status & SI5351_DEVICE_STATUS_SYS_INIT_bm) ? "Device is in system initialization mode" : "Device is ready");
+    printf("    LOL_B     : %s \n", (status & SI5351_DEVICE_STATUS_LOL_B_bm) ? "Unlocked" : "Locked");
+    printf("    LOL_A     : %s \n", (status & SI5351_DEVICE_STATUS_LOL_A_bm) ? "Unlocked" : "Locked");
+    printf("    LOS_CLKIN : %s \n", (status & SI5351_DEVICE_STATUS_LOS_CLKIN_bm) ? "Loss": "Valid");
+    printf("    LOS_XTAL  : %s \n", (status & SI5351_DEVICE_STATUS_LOS_XTAL_bm) ? "Loss": "Valid");
+    printf("    REVID     : %i \n", (status & SI5351_DEVICE_STATUS_REVID_bm));
+}
@@ -10,21 +10,37 @@
  */
 
 #include "si5351.h"
+#include "si5351_private.h"
 #include <math.h>
+#include <string.h>
+#if defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#endif
 
 
 // function prototype
-si5351_err_t si5351_set_default();
-si5351_err_t si5351_get_ram();
-si5351_err_t si5351_set_crystal_frequency(si5351_crystal_freq_t frequency);
+si5351_err_t si5351_set_default(si5351_t* dev);
+si5351_err_t si5351_get_ram(si5351_t* dev);
+void si5351_decode_pll(si5351_t* dev, si5351_pll_reg_t pll);
+void si5351_decode_multisynth(si5351_t* dev, si5351_ms_clk_reg_t ms, uint8_t control, const uint8_t* divider);
+si5351_err_t si5351_set_crystal_frequency(si5351_t* dev, si5351_crystal_freq_t frequency);
 si5351_err_t si5351_get_revision_id(si5351_variant_t, si5351_revision_t* rev_id);
-uint32_t si5351_get_pll_source_frequency(si5351_pll_reg_t pll);
-si5351_err_t si5351_read_reg(uint8_t reg, uint8_t* data);
-si5351_err_t si5351_write_reg(uint8_t reg, uint8_t data);
-bool si5351_is_clk_source_valid(si5351_ms_clk_reg_t clk, si5351_clk_source_t* clk_source);
-bool si5351_is_variant_b(si5351_variant_t variant);
-bool si5351_is_variant_c(si5351_variant_t variant);
-bool si5351_is_even_integer(uint16_t val);
+si5351_err_t si5351_write_burst(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count);
+si5351_err_t si5351_write_bursts(si5351_t* dev, si5351_burst_t* bursts, uint8_t count);
+si5351_err_t si5351_i2c_write(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count);
+void si5351_cache_update(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count);
+void si5351_cache_invalidate(si5351_t* dev);
+bool si5351_is_reg_shadowed(si5351_t* dev, uint8_t reg);
+bool si5351_is_reg_bridgeable(si5351_t* dev, uint8_t reg);
+bool si5351_is_clk_source_valid(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_clk_source_t* clk_source);
+uint64_t si5351_scale(uint64_t x, uint32_t k, uint64_t n);
+uint64_t si5351_udiv64(uint64_t n, uint32_t d);
+bool si5351_get_vfo_divider(si5351_ms_clk_reg_t clk, uint64_t frequency, uint16_t* a, uint8_t* r);
+si5351_err_t si5351_set_pll_vco_millihertz(si5351_t* dev, si5351_pll_reg_t pll, uint64_t vco_freq);
+si5351_err_t si5351_write_multisynth_integer(si5351_t* dev, si5351_ms_clk_reg_t clk, uint16_t a, uint8_t r);
+void si5351_add_lock_time(si5351_t* dev, si5351_pll_reg_t pll, uint32_t usec);
 
 
 const uint8_t si5351_clk_register[SI5351_MS_CLK_COUNT] = {
@@ -45,14 +61,10 @@ const uint8_t si5351_pll_int_register[SI5351_PLL_COUNT] = {
     SI5351_CLK6_CONTROL, SI5351_CLK7_CONTROL
 };
 
-#define SI5351_GOTO_ON_ERROR(x,jump) do {       \
-        result = x;                             \
-        if (result != ESP_OK) {                 \
-            goto jump;                          \
-        }                                       \
-    } while(0)
-
-#define SI5351_DIVIDE_ROUND(n, d)       (((n) + (d) / 2) / (d))
+#define SI5351_UDIV64_ROUND(n, d)       si5351_udiv64((n) + (d) / 2, (d))
+#define SI5351_COMMIT_BURSTS_MAX        8
+#define SI5351_FRACTION_C_MAX           (SI5351_MULTISYNTH_P3_bm)
+#define SI5351_PLLB_VARIANT_B_C         (1000000UL)
 
 si5351_t chip = {
         .initialised = false,
@@ -70,24 +82,31 @@ si5351_t chip = {
 
 
 
-si5351_err_t si5351_init(si5351_variant_t variant,
-                         uint8_t i2c_address,
-                         si5351_crystal_freq_t xtal_frequency,
-                         uint32_t clkin_frequency,
-                         bool unbreakable)
+si5351_err_t si5351_dev_init(si5351_t* dev, const si5351_bus_t* bus,
+                             si5351_variant_t variant,
+                             uint8_t i2c_address,
+                             si5351_crystal_freq_t xtal_frequency,
+                             uint32_t clkin_frequency,
+                             bool unbreakable)
 {
     si5351_err_t result;
-    chip.variant = variant;
-    SI5351_GOTO_ON_ERROR(si5351_get_revision_id(variant, &(chip.rev_id)), finish);
-    chip.i2c_address = i2c_address;
+    memset(dev, 0, sizeof(si5351_t));
+    if ((bus == NULL) || (bus->read == NULL) || (bus->write == NULL) || (bus->delay_msec == NULL)) {
+        result = SI5351_ERR_INVALID_ARG;
+        goto finish;
+    }
+    dev->bus = bus;
+    dev->variant = variant;
+    SI5351_GOTO_ON_ERROR(si5351_get_revision_id(variant, &(dev->rev_id)), finish);
+    dev->i2c_address = i2c_address;
     uint8_t timeout = SI5351_POWERUP_TIME_ms;
     uint8_t sys_init = 0xFF;
     while (timeout && (result == SI5351_OK)) {
-        uint8_t status;
-        result = si5351_i2c_read(chip.i2c_address, SI5351_DEVICE_STATUS, &status, 1);
+        uint8_t status = SI5351_DEVICE_STATUS_SYS_INIT_bm;
+        result = si5351_i2c_read(dev, SI5351_DEVICE_STATUS, &status, 1);
         sys_init = status & SI5351_DEVICE_STATUS_SYS_INIT_bm;
         if (sys_init == 0x00) break;
-        si5351_delay_msec(1);
+        dev->bus->delay_msec(dev->bus->ctx, 1);
         timeout--;
     }
     if (result != SI5351_OK) goto finish;
@@ -95,105 +114,232 @@ si5351_err_t si5351_init(si5351_variant_t variant,
         result = SI5351_ERR_TIMEOUT;
         goto finish;
     }
-    SI5351_GOTO_ON_ERROR(si5351_set_crystal_frequency(xtal_frequency), finish);
+    SI5351_GOTO_ON_ERROR(si5351_set_crystal_frequency(dev, xtal_frequency), finish);
     if ((clkin_frequency == 0) || ((clkin_frequency >= SI5351_CLKIN_MIN) && (clkin_frequency <= SI5351_CLKIN_MAX))) {
-        chip.clkin_freq = clkin_frequency;
+        dev->clkin_freq = clkin_frequency;
     } else {
-        chip.clkin_freq = 0;
+        dev->clkin_freq = 0;
         result = SI5351_ERR_INVALID_ARG;
     }
-    if ((chip.clkin_freq == 0) && (chip.crystal_freq == 0)) result = SI5351_ERR_INVALID_ARG;
+    if ((dev->clkin_freq == 0) && (dev->crystal_freq == 0)) result = SI5351_ERR_INVALID_ARG;
     if (result != SI5351_OK) goto finish;
     if (unbreakable) {
         // get current configuration
-        si5351_get_ram();
+        SI5351_GOTO_ON_ERROR(si5351_get_ram(dev), finish);
     } else {
-        // reset to default
-        SI5351_GOTO_ON_ERROR(si5351_set_powerdown(), finish);
-        SI5351_GOTO_ON_ERROR(si5351_set_default(), finish);
-        SI5351_GOTO_ON_ERROR(si5351_reset_pll(), finish);
+        // reset to default, outputs are disabled and powered down by the first burst, the control
+        // registers are rewritten by the defaults so they are not read first
+        uint8_t data[SI5351_MS_CLK_COUNT];
+        memset(data, SI5351_CLK_CONTROL_CLK_PDN_bm, sizeof(data));
+        si5351_dev_begin(dev);
+        result = si5351_write_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, 0xFF);
+        if (result == SI5351_OK) result = si5351_write_regs(dev, SI5351_CLK0_CONTROL, data, SI5351_MS_CLK_COUNT);
+        if (result == SI5351_OK) result = si5351_set_default(dev);
+        if (result == SI5351_OK) {
+            result = si5351_dev_commit(dev);
+        } else {
+            si5351_dev_abort(dev);
+        }
+        if (result != SI5351_OK) goto finish;
+        SI5351_GOTO_ON_ERROR(si5351_dev_reset_pll(dev), finish);
     }
-    chip.initialised = true;
+    dev->initialised = true;
 finish:
     return result;
 }
 
-si5351_err_t si5351_set_default()
+si5351_err_t si5351_set_default(si5351_t* dev)
 {
     si5351_err_t result;
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_INTERRUPT_STATUS_STICKY, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_INTERRUPT_STATUS_MASK, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_OEB_PIN_ENABLE_CONTROL_MASK, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_set_pll_source(SI5351_PLL_XTAL, SI5351_PLL_XTAL, SI5351_CLKIN_DIVIDER1), finish);
+    uint8_t data[SI5351_CLK7_TO_4_DISABLE_STATE - SI5351_CLK0_CONTROL + 1];
 #if (SI5351_DEFAULT_CLK_POWERDOWN == 0)
     uint8_t clk_state = 0x00;
 #else
     uint8_t clk_state = 0x80;
 #endif
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK0_CONTROL, clk_state), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK1_CONTROL, clk_state), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK2_CONTROL, clk_state), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK3_CONTROL, clk_state), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK4_CONTROL, clk_state), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK5_CONTROL, clk_state), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK6_CONTROL, clk_state), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK7_CONTROL, clk_state), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK3_TO_0_DISABLE_STATE, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK7_TO_4_DISABLE_STATE, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK0_INITIAL_PHASE_OFFSET, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK1_INITIAL_PHASE_OFFSET, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK2_INITIAL_PHASE_OFFSET, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK3_INITIAL_PHASE_OFFSET, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK4_INITIAL_PHASE_OFFSET, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_CLK5_INITIAL_PHASE_OFFSET, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_write_reg(SI5351_SPREAD_SPECTRUM_PARAMETERS, 0x00), finish);
-    SI5351_GOTO_ON_ERROR(si5351_set_crystal_load(SI5351_CRYSTAL_LOAD_10PF), finish);
-    SI5351_GOTO_ON_ERROR(si5351_set_fanout(false, false, false), finish);
+    // the blocks below are merged with the PLL source register into a single burst
+    si5351_dev_begin(dev);
+    // interrupt status sticky, interrupt status mask
+    memset(data, 0x00, sizeof(data));
+    SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, SI5351_INTERRUPT_STATUS_STICKY, data, 2), finish);
+    SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, SI5351_OEB_PIN_ENABLE_CONTROL_MASK, 0x00), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_pll_source(dev, SI5351_PLL_XTAL, SI5351_PLL_XTAL, SI5351_CLKIN_DIVIDER1), finish);
+    // CLK0..CLK7 control, CLK0..CLK7 disable state
+    memset(data, clk_state, SI5351_MS_CLK_COUNT);
+    SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, SI5351_CLK0_CONTROL, data, sizeof(data)), finish);
+    SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, SI5351_SPREAD_SPECTRUM_PARAMETERS, 0x00), finish);
+    // CLK0..CLK5 initial phase offset
+    memset(data, 0x00, sizeof(data));
+    SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, SI5351_CLK0_INITIAL_PHASE_OFFSET, data, SI5351_CLK5_INITIAL_PHASE_OFFSET - SI5351_CLK0_INITIAL_PHASE_OFFSET + 1), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_crystal_load(dev, SI5351_CRYSTAL_LOAD_10PF), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_fanout(dev, false, false, false), finish);
 finish:
+    if (result == SI5351_OK) {
+        result = si5351_dev_commit(dev);
+    } else {
+        si5351_dev_abort(dev);
+    }
     return result;
 }
 
-si5351_err_t si5351_get_ram()
+si5351_err_t si5351_get_ram(si5351_t* dev)
 {
     si5351_err_t result = SI5351_OK;
-    uint8_t data;
-    SI5351_GOTO_ON_ERROR(si5351_read_reg(SI5351_CRYSTAL_INTERNAL_LOAD_CAP, &data), finish);
-    chip.crystal_load = (si5351_crystal_load_t)(data & SI5351_CRYSTAL_INTERNAL_LOAD_CAP_XTAL_CL_bm);
+    uint8_t* regs = dev->regs;
+    // registers 0..92, 149..170 and 177..187 are read straight into the shadow
+    SI5351_GOTO_ON_ERROR(si5351_read_regs(dev, SI5351_DEVICE_STATUS, &(regs[SI5351_DEVICE_STATUS]),
+            SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER - SI5351_DEVICE_STATUS + 1), finish);
+    SI5351_GOTO_ON_ERROR(si5351_read_regs(dev, SI5351_SPREAD_SPECTRUM_PARAMETERS, &(regs[SI5351_SPREAD_SPECTRUM_PARAMETERS]),
+            SI5351_CLK5_INITIAL_PHASE_OFFSET - SI5351_SPREAD_SPECTRUM_PARAMETERS + 1), finish);
+    SI5351_GOTO_ON_ERROR(si5351_read_regs(dev, SI5351_PLL_RESET, &(regs[SI5351_PLL_RESET]),
+            SI5351_FANOUT_ENABLE - SI5351_PLL_RESET + 1), finish);
+    uint8_t data = regs[SI5351_PLL_INPUT_SOURCE];
+    dev->clkin_divider = (1 << ((data & SI5351_PLL_INPUT_SOURCE_CLKIN_DIV_bm) >> SI5351_PLL_INPUT_SOURCE_CLKIN_DIV_bp));
+    dev->pll[SI5351_PLLA].source = (data & SI5351_PLL_INPUT_SOURCE_PLLA_SRC_bm) ? SI5351_PLL_CLKINT : SI5351_PLL_XTAL;
+    dev->pll[SI5351_PLLB].source = (data & SI5351_PLL_INPUT_SOURCE_PLLB_SRC_bm) ? SI5351_PLL_CLKINT : SI5351_PLL_XTAL;
+    for (int i = SI5351_PLLA; i < SI5351_PLL_COUNT; i++) {
+        si5351_decode_pll(dev, i);
+    }
+    for (int i = SI5351_MS_CLK0; i < SI5351_MS_CLK6; i++) {
+        si5351_decode_multisynth(dev, i, regs[si5351_clk_register[i]], &(regs[si5351_multisynth_register[i]]));
+    }
+    for (int i = SI5351_MS_CLK6; i < SI5351_MS_CLK_COUNT; i++) {
+        uint8_t divider[2] = { regs[si5351_multisynth_register[i]], regs[SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER] };
+        si5351_decode_multisynth(dev, i, regs[si5351_clk_register[i]], divider);
+    }
+    dev->crystal_load = (si5351_crystal_load_t)(regs[SI5351_CRYSTAL_INTERNAL_LOAD_CAP] & SI5351_CRYSTAL_INTERNAL_LOAD_CAP_XTAL_CL_bm);
+    dev->fanout_bm = regs[SI5351_FANOUT_ENABLE] & (SI5351_FANOUT_ENABLE_CLKIN_bm | SI5351_FANOUT_ENABLE_XO_bm | SI5351_FANOUT_ENABLE_MS_bm);
 finish:
     return result;
 }
 
-si5351_err_t si5351_get_status(uint8_t* status)
+void si5351_decode_pll(si5351_t* dev, si5351_pll_reg_t pll)
+{
+    uint32_t p1, p2, p3;
+    uint8_t pll_reg = (pll == SI5351_PLLA) ? SI5351_MULTISYNTH_NA_PARAMETERS : SI5351_MULTISYNTH_NB_PARAMETERS;
+    dev->pll[pll].configured = false;
+    dev->pll[pll].frequency = 0;
+    si5351_get_parameters(&(dev->regs[pll_reg]), &p1, &p2, &p3);
+    uint32_t in_frequency = si5351_get_pll_source_frequency(dev, pll);
+    if ((in_frequency < SI5351_PLL_CLKIN_MIN) || (in_frequency > SI5351_PLL_CLKIN_MAX)) return;
+    if (p3 == 0) return;
+    uint32_t a = (p1 + 512) / 128;
+    if ((a < SI5351_PLL_INT_MIN) || (a > SI5351_PLL_INT_MAX)) return;
+    // a + b / c = ((p1 + 512) * p3 + p2) / (128 * p3)
+    uint64_t n = (uint64_t)(p1 + 512) * p3 + p2;
+    dev->pll[pll].frequency = (uint32_t)SI5351_DIVIDE_ROUND(in_frequency * n, (uint64_t)128 * p3);
+    dev->pll[pll].error = si5351_get_vco_error(in_frequency, dev->pll[pll].frequency, a, ((p1 + 512) % 128) * p3 + p2, 128 * p3);
+    dev->pll[pll].configured = true;
+}
+
+// divider holds the 8 parameter registers of MS0..MS5, or the MS6/MS7 divider and the
+// CLOCK_6_AND_7_OUTPUT_DIVIDER register
+void si5351_decode_multisynth(si5351_t* dev, si5351_ms_clk_reg_t ms, uint8_t control, const uint8_t* divider)
+{
+    si5351_pll_reg_t pll = (control & SI5351_CLK_CONTROL_MS_SRC_bm) ? SI5351_PLLB : SI5351_PLLA;
+    dev->ms[ms].pll = pll;
+    dev->ms[ms].configured = false;
+    dev->ms[ms].frequency = 0;
+    switch (ms) {
+        case SI5351_MS_CLK6:
+            dev->ms[ms].r_div = (si5351_clk_r_div_t)(((divider[1] & SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R6_DIV_bm)
+                    >> SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R6_DIV_bp) << SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp);
+            break;
+        case SI5351_MS_CLK7:
+            dev->ms[ms].r_div = (si5351_clk_r_div_t)(((divider[1] & SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R7_DIV_bm)
+                    >> SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R7_DIV_bp) << SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp);
+            break;
+        default:
+            dev->ms[ms].r_div = (si5351_clk_r_div_t)(divider[2] & SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm);
+    }
+    if (!dev->pll[pll].configured) return;
+    uint64_t vco_freq = si5351_get_vco_millihertz(dev, pll);
+    uint64_t frequency;
+    if ((ms == SI5351_MS_CLK6) || (ms == SI5351_MS_CLK7)) {
+        uint8_t a = divider[0];
+        if ((a < SI5351_MULTISYNTH_INT_0_TO_7_MIN) || !si5351_is_even_integer(a)) return;
+        frequency = SI5351_DIVIDE_ROUND(vco_freq, a);
+    } else if ((divider[2] & SI5351_MULTISYNTH0_PARAMETERS_MS_DIV4_bm) == SI5351_MULTISYNTH0_PARAMETERS_MS_DIV4_bm) {
+        frequency = SI5351_DIVIDE_ROUND(vco_freq, SI5351_MULTISYNTH_INT_0_TO_5_DIV4);
+    } else {
+        uint32_t p1, p2, p3;
+        si5351_get_parameters((uint8_t*)divider, &p1, &p2, &p3);
+        if (p3 == 0) return;
+        uint32_t a = (p1 + 512) / 128;
+        if ((a < SI5351_MULTISYNTH_INT_0_TO_7_MIN) || (a > SI5351_MULTISYNTH_FRAC_0_TO_5_MAX)) return;
+        // vco / (a + b / c) = vco * 128 * p3 / ((p1 + 512) * p3 + p2)
+        uint64_t n = (uint64_t)(p1 + 512) * p3 + p2;
+        frequency = si5351_scale(vco_freq, 128 * p3, n);
+    }
+    dev->ms[ms].frequency = (uint32_t)SI5351_DIVIDE_ROUND(frequency, 1000);
+    dev->ms[ms].error = (int32_t)(frequency - (uint64_t)dev->ms[ms].frequency * 1000);
+    dev->ms[ms].configured = true;
+}
+
+void si5351_get_parameters(uint8_t* data, uint32_t* p1, uint32_t* p2, uint32_t* p3)
+{
+    *p3 = ((uint32_t)(data[5] & 0xF0) << 12) | ((uint32_t)data[0] << 8) | data[1];
+    *p1 = ((uint32_t)(data[2] & 0x03) << 16) | ((uint32_t)data[3] << 8) | data[4];
+    *p2 = ((uint32_t)(data[5] & 0x0F) << 16) | ((uint32_t)data[6] << 8) | data[7];
+}
+
+si5351_err_t si5351_set_parameters(uint8_t* data, uint32_t a, uint32_t b, uint32_t c)
+{
+    // a + b / c into the 8 parameter registers, R divider and MS_DIV4 bits left clear
+    uint32_t p3 = c;
+    if (p3 & ~((uint32_t)SI5351_MULTISYNTH_P3_bm)) return SI5351_ERR_INVALID_ARG;
+    uint32_t whole = (128 * b) / c;
+    uint32_t p1 = (uint32_t)128 * a + whole - 512;
+    if (p1 & ~((uint32_t)SI5351_MULTISYNTH_P1_bm)) return SI5351_ERR_INVALID_ARG;
+    uint32_t p2 = 128 * b - c * whole;
+    if (p2 & ~((uint32_t)SI5351_MULTISYNTH_P2_bm)) return SI5351_ERR_INVALID_ARG;
+    si5351_put_parameters(data, p1, p2, p3);
+    return SI5351_OK;
+}
+
+void si5351_put_parameters(uint8_t* data, uint32_t p1, uint32_t p2, uint32_t p3)
+{
+    data[0] = (uint8_t)((p3 >> 8) & 0xFF);
+    data[1] = (uint8_t)(p3 & 0xFF);
+    data[2] = (uint8_t)((p1 >> 16) & 0x03);
+    data[3] = (uint8_t)((p1 >> 8) & 0xFF);
+    data[4] = (uint8_t)(p1 & 0xFF);
+    data[5] = (uint8_t)(((p3 >> 12) & 0xF0) | ((p2 >> 16) & 0x0F));
+    data[6] = (uint8_t)((p2 >> 8) & 0xFF);
+    data[7] = (uint8_t)(p2 & 0xFF);
+}
+
+si5351_err_t si5351_dev_get_status(si5351_t* dev, uint8_t* status)
 {
     si5351_err_t result;
-    result = si5351_i2c_read(chip.i2c_address, SI5351_DEVICE_STATUS, status, 1);
+    result = si5351_i2c_read(dev, SI5351_DEVICE_STATUS, status, 1);
     return result;
 }
 
-si5351_err_t si5351_set_crystal_frequency(si5351_crystal_freq_t frequency)
+si5351_err_t si5351_set_crystal_frequency(si5351_t* dev, si5351_crystal_freq_t frequency)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((frequency == SI5351_CRYSTAL_FREQ_25MHZ) || (frequency == SI5351_CRYSTAL_FREQ_27MHZ) || (frequency == SI5351_CRYSTAL_NONE)) {
-        chip.crystal_freq = frequency * 1000000;
+        dev->crystal_freq = frequency * 1000000;
         result = SI5351_OK;
     } else {
-        chip.crystal_freq = 0;
+        dev->crystal_freq = 0;
     }
     return result;
 }
 
-si5351_err_t si5351_set_crystal_load(si5351_crystal_load_t cap)
+si5351_err_t si5351_dev_set_crystal_load(si5351_t* dev, si5351_crystal_load_t cap)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((cap & ~(SI5351_CRYSTAL_INTERNAL_LOAD_CAP_XTAL_CL_bm)) == 0x00) {
         uint8_t data = ((uint8_t)cap & SI5351_CRYSTAL_INTERNAL_LOAD_CAP_XTAL_CL_bm) | SI5351_CRYSTAL_INTERNAL_LOAD_CAP_RESERVED_bm;
-        result = si5351_i2c_write(chip.i2c_address, SI5351_CRYSTAL_INTERNAL_LOAD_CAP, &data, 1);
-        if (result == SI5351_OK) chip.crystal_load = cap;
+        result = si5351_write_reg(dev, SI5351_CRYSTAL_INTERNAL_LOAD_CAP, data);
+        if (result == SI5351_OK) dev->crystal_load = cap;
     }
     return result;
 }
 
-si5351_err_t si5351_set_pll_source(si5351_pll_source_t plla, si5351_pll_source_t pllb, si5351_clkin_divider_t div)
+si5351_err_t si5351_dev_set_pll_source(si5351_t* dev, si5351_pll_source_t plla, si5351_pll_source_t pllb, si5351_clkin_divider_t div)
 {
     si5351_err_t result;
     if ((div & ~(SI5351_PLL_INPUT_SOURCE_CLKIN_DIV_bm)) != 0) {
@@ -201,17 +347,17 @@ si5351_err_t si5351_set_pll_source(si5351_pll_source_t plla, si5351_pll_source_t
         goto finish;
     }
     if (((plla == SI5351_PLL_XTAL) || (plla == SI5351_PLL_CLKINT)) && ((pllb == SI5351_PLL_XTAL) || (pllb == SI5351_PLL_CLKINT))) {
-        if (!(si5351_is_variant_c(chip.variant)) && ((plla == SI5351_PLL_CLKINT) || (pllb == SI5351_PLL_CLKINT))) {
+        if (!(si5351_is_variant_c(dev->variant)) && ((plla == SI5351_PLL_CLKINT) || (pllb == SI5351_PLL_CLKINT))) {
             result = SI5351_ERR_INVALID_ARG;
         } else {
             uint8_t data = div & SI5351_PLL_INPUT_SOURCE_CLKIN_DIV_bm;
             if (plla == SI5351_PLL_CLKINT) data |= SI5351_PLL_INPUT_SOURCE_PLLA_SRC_bm;
             if (pllb == SI5351_PLL_CLKINT) data |= SI5351_PLL_INPUT_SOURCE_PLLB_SRC_bm;
-            result = si5351_i2c_write(chip.i2c_address, SI5351_PLL_INPUT_SOURCE, &data, 1);
+            result = si5351_write_reg(dev, SI5351_PLL_INPUT_SOURCE, data);
             if (result == SI5351_OK) {
-                chip.clkin_divider = (1 << ((div & SI5351_PLL_INPUT_SOURCE_CLKIN_DIV_bm) >> SI5351_PLL_INPUT_SOURCE_CLKIN_DIV_bp));
-                chip.pll[SI5351_PLLA].source = plla;
-                chip.pll[SI5351_PLLB].source = pllb;
+                dev->clkin_divider = (1 << ((div & SI5351_PLL_INPUT_SOURCE_CLKIN_DIV_bm) >> SI5351_PLL_INPUT_SOURCE_CLKIN_DIV_bp));
+                dev->pll[SI5351_PLLA].source = plla;
+                dev->pll[SI5351_PLLB].source = pllb;
             }
         }
     } else {
@@ -221,85 +367,86 @@ finish:
     return result;
 }
 
-uint32_t si5351_get_pll_source_frequency(si5351_pll_reg_t pll)
+uint32_t si5351_get_pll_source_frequency(si5351_t* dev, si5351_pll_reg_t pll)
 {
     uint32_t result = 0;
     if ((pll >= SI5351_PLLA) && (pll < SI5351_PLL_COUNT)) {
-        if (chip.pll[pll].source == SI5351_PLL_XTAL) result = chip.crystal_freq;
-        if (chip.pll[pll].source == SI5351_PLL_CLKINT) result = SI5351_DIVIDE_ROUND(chip.clkin_freq, chip.clkin_divider);
+        if (dev->pll[pll].source == SI5351_PLL_XTAL) result = dev->crystal_freq;
+        if (dev->pll[pll].source == SI5351_PLL_CLKINT) result = SI5351_DIVIDE_ROUND(dev->clkin_freq, dev->clkin_divider);
     }
     return result;
 }
 
-si5351_err_t si5351_set_pll_vco(si5351_pll_reg_t pll, uint32_t frequency)
+si5351_err_t si5351_dev_set_pll_vco(si5351_t* dev, si5351_pll_reg_t pll, uint32_t frequency)
 {
     si5351_err_t result = SI5351_OK;
     if ((pll < SI5351_PLLA) || (pll >= SI5351_PLL_COUNT)) result = SI5351_ERR_INVALID_ARG;
-    if (!chip.initialised) result = SI5351_ERR_NOT_INITIALISED;
+    if (!dev->initialised) result = SI5351_ERR_NOT_INITIALISED;
     if (result != SI5351_OK) goto finish;
 #if (SI5351_ALLOW_OVERCLOCKING == 0)
     if (frequency < SI5351_PLL_VCO_MIN) frequency = SI5351_PLL_VCO_MIN;
     if (frequency > SI5351_PLL_VCO_MAX) frequency = SI5351_PLL_VCO_MAX;
 #endif
-    uint32_t in_frequency = si5351_get_pll_source_frequency(pll);
+    uint32_t in_frequency = si5351_get_pll_source_frequency(dev, pll);
     if ((in_frequency < SI5351_PLL_CLKIN_MIN) || (in_frequency > SI5351_PLL_CLKIN_MAX)) {
         result = SI5351_ERR_INVALID_ARG;
         goto finish;
     }
     uint8_t a = (uint8_t)(frequency / in_frequency);
-    if (in_frequency * a == frequency) {
-        result = si5351_set_pll_vco_integer(pll, a);
+    uint32_t r = frequency % in_frequency;
+    uint32_t b, c;
+    if ((pll == SI5351_PLLB) && si5351_is_variant_b(dev->variant)) {
+        // VCXO tuning needs PLLB with c = 10^6
+        c = SI5351_PLLB_VARIANT_B_C;
+        b = (uint32_t)SI5351_UDIV64_ROUND((uint64_t)r * c, in_frequency);
+    } else {
+        si5351_get_best_fraction(r, in_frequency, SI5351_FRACTION_C_MAX, &b, &c);
+    }
+    if (b == c) {
+        a++;
+        b = 0;
+    }
+    if ((b == 0) && (c == 1)) {
+        result = si5351_dev_set_pll_vco_integer(dev, pll, a);
     } else {
-        uint32_t c = 0xFFFFF;
-        if ((pll == SI5351_PLLB) && si5351_is_variant_b(chip.variant)) c = 0xF4240;
-        uint32_t b = (uint32_t)SI5351_DIVIDE_ROUND((((uint64_t)frequency % in_frequency) * c), in_frequency);
-        result = si5351_set_pll_vco_fractional(pll, a, b, c);
+        result = si5351_dev_set_pll_vco_fractional(dev, pll, a, b, c);
+    }
+    if (result == SI5351_OK) {
+        dev->pll[pll].frequency = frequency;
+        dev->pll[pll].error = si5351_get_vco_error(in_frequency, frequency, a, b, c);
     }
 finish:
     return result;
 }
 
-si5351_err_t si5351_set_pll_vco_integer(si5351_pll_reg_t pll, uint8_t a)
+si5351_err_t si5351_dev_set_pll_vco_integer(si5351_t* dev, si5351_pll_reg_t pll, uint8_t a)
 {
-    return si5351_set_pll_vco_fractional(pll, a, 0, 1);
+    return si5351_dev_set_pll_vco_fractional(dev, pll, a, 0, 1);
 }
 
-si5351_err_t si5351_set_pll_vco_fractional(si5351_pll_reg_t pll, uint8_t a, uint32_t b, uint32_t c)
+si5351_err_t si5351_dev_set_pll_vco_fractional(si5351_t* dev, si5351_pll_reg_t pll, uint8_t a, uint32_t b, uint32_t c)
 {
     si5351_err_t result = SI5351_OK;
     if ((pll < SI5351_PLLA) || (pll >= SI5351_PLL_COUNT)) result = SI5351_ERR_INVALID_ARG;
-    if (!chip.initialised) result = SI5351_ERR_NOT_INITIALISED;
+    if (!dev->initialised) result = SI5351_ERR_NOT_INITIALISED;
     if ((c == 0) || (b >= c)) result = SI5351_ERR_INVALID_ARG;
     if ((a < SI5351_PLL_INT_MIN) || (a > SI5351_PLL_INT_MAX)) result = SI5351_ERR_INVALID_ARG;
-    if ((pll == SI5351_PLLB) && si5351_is_variant_b(chip.variant) && (c != 0xF4240)) result = SI5351_ERR_INVALID_ARG;
+    if ((pll == SI5351_PLLB) && si5351_is_variant_b(dev->variant) && (c != SI5351_PLLB_VARIANT_B_C)) result = SI5351_ERR_INVALID_ARG;
     if (result != SI5351_OK) goto finish;
-    uint32_t in_frequency = si5351_get_pll_source_frequency(pll);
+    uint32_t in_frequency = si5351_get_pll_source_frequency(dev, pll);
     if ((in_frequency < SI5351_PLL_CLKIN_MIN) || (in_frequency > SI5351_PLL_CLKIN_MAX)) {
         result = SI5351_ERR_INVALID_ARG;
         goto finish;
     }
-    uint32_t frequency = (uint32_t)(SI5351_DIVIDE_ROUND((uint64_t)in_frequency * b, c) + in_frequency * a);
+    uint32_t frequency = (uint32_t)(SI5351_UDIV64_ROUND((uint64_t)in_frequency * b, c) + in_frequency * a);
 #if (SI5351_ALLOW_OVERCLOCKING == 0)
     if ((frequency < SI5351_PLL_VCO_MIN) || (frequency > SI5351_PLL_VCO_MAX)) {
         result = SI5351_ERR_INVALID_ARG;
         goto finish;
     }
 #endif
-    uint32_t p3 = c;
-    if (p3 & ~((uint32_t)SI5351_MULTISYNTH_P3_bm)) {
-        result = SI5351_ERR_INVALID_ARG;
-        goto finish;
-    }
-    uint32_t p1 = (uint32_t)128 * a + ((128 * b) / c) - 512;
-    if (p1 & ~((uint32_t)SI5351_MULTISYNTH_P1_bm)) {
-        result = SI5351_ERR_INVALID_ARG;
-        goto finish;
-    }
-    uint32_t p2 = 128 * b - c * ((128 * b) / c);
-    if (p2 & ~((uint32_t)SI5351_MULTISYNTH_P2_bm)) {
-        result = SI5351_ERR_INVALID_ARG;
-        goto finish;
-    }
+    uint8_t data[SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH];
+    SI5351_GOTO_ON_ERROR(si5351_set_parameters(data, a, b, c), finish);
     uint8_t pll_reg;
     switch (pll) {
         case SI5351_PLLA:
@@ -312,38 +459,30 @@ si5351_err_t si5351_set_pll_vco_fractional(si5351_pll_reg_t pll, uint8_t a, uint
             result = SI5351_ERR_INVALID_ARG;
             goto finish;
     }
-    uint8_t data[SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH];
-    data[0] = (uint8_t)((p3 >> 8) & 0xFF);
-    data[1] = (uint8_t)(p3 & 0xFF);
-    data[2] = (uint8_t)((p1 >> 16) & 0x03);
-    data[3] = (uint8_t)((p1 >> 8) & 0xFF);
-    data[4] = (uint8_t)(p1 & 0xFF);
-    data[5] = (uint8_t)(((p3 >> 12) & 0xF0) | ((p2 >> 16) & 0x0F));
-    data[6] = (uint8_t)((p2 >> 8) & 0xFF);
-    data[7] = (uint8_t)(p2 & 0xFF);
-    result = si5351_i2c_write(chip.i2c_address, pll_reg, data, SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH);
+    result = si5351_write_regs(dev, pll_reg, data, SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH);
     if (result == SI5351_OK) {
-        chip.pll[pll].frequency = frequency;
-        chip.pll[pll].configured = true;
+        dev->pll[pll].frequency = frequency;
+        dev->pll[pll].error = si5351_get_vco_error(in_frequency, frequency, a, b, c);
+        dev->pll[pll].configured = true;
     }
 finish:
     return result;
 }
 
-si5351_err_t si5351_set_pll_mode_integer(si5351_pll_reg_t pll, bool integer)
+si5351_err_t si5351_dev_set_pll_mode_integer(si5351_t* dev, si5351_pll_reg_t pll, bool integer)
 {
     si5351_err_t result = SI5351_OK;
     if ((pll >= SI5351_PLLA) && (pll < SI5351_PLL_COUNT)) {
         uint8_t reg = si5351_pll_int_register[pll];
         uint8_t data;
-        result = si5351_i2c_read(chip.i2c_address, reg, &data, 1);
+        result = si5351_read_reg(dev, reg, &data);
         if (result == SI5351_OK) {
             if (integer) {
                 data |= SI5351_CLK_CONTROL_FB_INT_bm;
             } else {
                 data &= ~(SI5351_CLK_CONTROL_FB_INT_bm);
             }
-            result = si5351_i2c_write(chip.i2c_address, reg, &data, 1);
+            result = si5351_write_reg(dev, reg, data);
         }
     } else {
         result = SI5351_ERR_INVALID_ARG;
@@ -351,15 +490,15 @@ si5351_err_t si5351_set_pll_mode_integer(si5351_pll_reg_t pll, bool integer)
     return result;
 }
 
-si5351_err_t si5351_get_pll_frequency(si5351_pll_reg_t pll, uint32_t* frequency)
+si5351_err_t si5351_dev_get_pll_frequency(si5351_t* dev, si5351_pll_reg_t pll, uint32_t* frequency)
 {
     si5351_err_t result = SI5351_OK;
     if ((pll >= SI5351_PLLA) && (pll < SI5351_PLL_COUNT)) {
-        if (!chip.pll[pll].configured) {
+        if (!dev->pll[pll].configured) {
             result = SI5351_ERR_NOT_INITIALISED;
             *frequency = 0;
         } else {
-            *frequency = chip.pll[pll].frequency;
+            *frequency = dev->pll[pll].frequency;
         }
     } else {
         result = SI5351_ERR_INVALID_ARG;
@@ -367,26 +506,123 @@ si5351_err_t si5351_get_pll_frequency(si5351_pll_reg_t pll, uint32_t* frequency)
     return result;
 }
 
-si5351_err_t si5351_reset_pll()
+si5351_err_t si5351_dev_get_pll_error(si5351_t* dev, si5351_pll_reg_t pll, int32_t* error)
+{
+    si5351_err_t result = SI5351_OK;
+    if ((pll >= SI5351_PLLA) && (pll < SI5351_PLL_COUNT)) {
+        if (!dev->pll[pll].configured) {
+            result = SI5351_ERR_NOT_INITIALISED;
+            *error = 0;
+        } else {
+            *error = dev->pll[pll].error;
+        }
+    } else {
+        result = SI5351_ERR_INVALID_ARG;
+    }
+    return result;
+}
+
+si5351_err_t si5351_dev_reset_pll(si5351_t* dev)
 {
     si5351_err_t result;
-    uint8_t data = SI5351_PLL_RESET_PLLA_RST_bm | SI5351_PLL_RESET_PLLB_RST_bm;
-    result = si5351_i2c_write(chip.i2c_address, SI5351_PLL_RESET, &data, 1);
+    result = si5351_write_reg(dev, SI5351_PLL_RESET, SI5351_PLL_RESET_PLLA_RST_bm | SI5351_PLL_RESET_PLLB_RST_bm);
     return result;
 }
 
-si5351_err_t si5351_set_multisynth(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint32_t frequency)
+si5351_err_t si5351_dev_reset_single_pll(si5351_t* dev, si5351_pll_reg_t pll)
+{
+    si5351_err_t result;
+    switch (pll) {
+        case SI5351_PLLA:
+            result = si5351_write_reg(dev, SI5351_PLL_RESET, SI5351_PLL_RESET_PLLA_RST_bm);
+            break;
+        case SI5351_PLLB:
+            result = si5351_write_reg(dev, SI5351_PLL_RESET, SI5351_PLL_RESET_PLLB_RST_bm);
+            break;
+        default:
+            result = SI5351_ERR_INVALID_ARG;
+    }
+    return result;
+}
+
+si5351_err_t si5351_dev_wait_lock(si5351_t* dev, uint8_t pll_mask, uint32_t timeout_usec, uint32_t* lock_usec)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((pll_mask == 0) || ((pll_mask >> SI5351_PLL_COUNT) != 0)) goto finish;
+    if (!dev->initialised) {
+        result = SI5351_ERR_NOT_INITIALISED;
+        goto finish;
+    }
+    // without a timer the status is polled every millisecond
+    bool timer = (dev->bus->get_time_usec != NULL);
+    uint32_t start = timer ? dev->bus->get_time_usec(dev->bus->ctx) : 0;
+    uint32_t elapsed = 0;
+    while (true) {
+        uint8_t status;
+        SI5351_GOTO_ON_ERROR(si5351_i2c_read(dev, SI5351_DEVICE_STATUS, &status, 1), finish);
+        if (timer) elapsed = dev->bus->get_time_usec(dev->bus->ctx) - start;
+        for (uint8_t pll = SI5351_PLLA; pll < SI5351_PLL_COUNT; pll++) {
+            uint8_t lol_bm = (pll == SI5351_PLLA) ? SI5351_DEVICE_STATUS_LOL_A_bm : SI5351_DEVICE_STATUS_LOL_B_bm;
+            if ((pll_mask & (1 << pll)) && ((status & lol_bm) == 0x00)) {
+                pll_mask &= ~(1 << pll);
+                si5351_add_lock_time(dev, pll, elapsed);
+            }
+        }
+        if (pll_mask == 0) break;
+        if (elapsed >= timeout_usec) {
+            for (uint8_t pll = SI5351_PLLA; pll < SI5351_PLL_COUNT; pll++) {
+                if ((pll_mask & (1 << pll)) && (dev->lock_timeouts[pll] < UINT16_MAX)) dev->lock_timeouts[pll]++;
+            }
+            result = SI5351_ERR_TIMEOUT;
+            goto finish;
+        }
+        if (timer) {
+            // whole milliseconds are slept, only the rest is spun on the timer
+            uint32_t poll = elapsed + SI5351_LOCK_POLL_usec;
+            uint32_t left = poll - (uint32_t)(dev->bus->get_time_usec(dev->bus->ctx) - start);
+            if ((left <= SI5351_LOCK_POLL_usec) && (left >= 1000)) dev->bus->delay_msec(dev->bus->ctx, left / 1000);
+            while ((uint32_t)(dev->bus->get_time_usec(dev->bus->ctx) - start) < poll);
+        } else {
+            dev->bus->delay_msec(dev->bus->ctx, 1);
+            elapsed += 1000;
+        }
+    }
+    if (lock_usec != NULL) *lock_usec = elapsed;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_dev_get_lock_histogram(si5351_t* dev, si5351_pll_reg_t pll, uint16_t* bins, uint16_t* timeouts)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((pll < SI5351_PLLA) || (pll >= SI5351_PLL_COUNT) || (bins == NULL)) goto finish;
+    memcpy(bins, dev->lock_histogram[pll], sizeof(dev->lock_histogram[pll]));
+    if (timeouts != NULL) *timeouts = dev->lock_timeouts[pll];
+    result = SI5351_OK;
+finish:
+    return result;
+}
+
+void si5351_dev_clear_lock_histogram(si5351_t* dev)
+{
+    memset(dev->lock_histogram, 0, sizeof(dev->lock_histogram));
+    memset(dev->lock_timeouts, 0, sizeof(dev->lock_timeouts));
+}
+
+si5351_err_t si5351_dev_set_multisynth(si5351_t* dev, si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint32_t frequency)
 {
     si5351_err_t result = SI5351_OK;
     if ((ms < SI5351_MS_CLK0) || (ms >= SI5351_MS_CLK_COUNT)) result = SI5351_ERR_INVALID_ARG;
     if ((pll_source < SI5351_PLLA) || (pll_source >= SI5351_PLL_COUNT)) result = SI5351_ERR_INVALID_ARG;
     if (result != SI5351_OK) goto finish;
-    if (!chip.pll[pll_source].configured) {
+    if (!dev->pll[pll_source].configured) {
         result = SI5351_ERR_NOT_INITIALISED;
         goto finish;
     }
-    uint32_t vco_freq = chip.pll[pll_source].frequency;
+    uint32_t vco_freq = dev->pll[pll_source].frequency;
     uint16_t a = (uint16_t)(vco_freq / frequency);
+    uint32_t b = 0;
+    uint32_t c = 1;
     switch (ms) {
         case SI5351_MS_CLK0:
         case SI5351_MS_CLK1:
@@ -395,12 +631,13 @@ si5351_err_t si5351_set_multisynth(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_
         case SI5351_MS_CLK4:
         case SI5351_MS_CLK5:
 #if (SI5351_ALLOW_OVERCLOCKING == 0)
-            if ((chip.rev_id == SI5351_REVISION_A) && (frequency > SI5351_REVA_MULTISYNTH_FREQUENCY_MAX)) result = SI5351_ERR_INVALID_ARG;
-            if ((chip.rev_id == SI5351_REVISION_B) && (frequency > SI5351_REVB_MULTISYNTH_FREQUENCY_MAX)) result = SI5351_ERR_INVALID_ARG;
+            if ((dev->rev_id == SI5351_REVISION_A) && (frequency > SI5351_REVA_MULTISYNTH_FREQUENCY_MAX)) result = SI5351_ERR_INVALID_ARG;
+            if ((dev->rev_id == SI5351_REVISION_B) && (frequency > SI5351_REVB_MULTISYNTH_FREQUENCY_MAX)) result = SI5351_ERR_INVALID_ARG;
 #endif
             if ((a < SI5351_MULTISYNTH_FRAC_0_TO_5_MIN) && (a >= SI5351_MULTISYNTH_INT_0_TO_5_DIV4) && si5351_is_even_integer(a)) {
                 if ((vco_freq < a * (frequency + 1)) && (vco_freq > a * (frequency - 1))) {
-                    result = si5351_set_multisynth_integer(ms, pll_source, a);
+                    result = si5351_dev_set_multisynth_integer(dev, ms, pll_source, a);
+                    b = 0;
                 } else {
                     result = SI5351_ERR_INVALID_ARG;
                 }
@@ -411,12 +648,15 @@ si5351_err_t si5351_set_multisynth(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_
                 if (vco_freq < (frequency * SI5351_MULTISYNTH_FRAC_0_TO_5_MIN)) result = SI5351_ERR_INVALID_ARG;
 #endif
                 if (result != SI5351_OK) goto finish;
-                if ((vco_freq < a * (frequency + 1)) && (vco_freq > a * (frequency - 1))) {
-                    result = si5351_set_multisynth_integer(ms, pll_source, a);
+                si5351_get_best_fraction(vco_freq % frequency, frequency, SI5351_FRACTION_C_MAX, &b, &c);
+                if (b == c) {
+                    a++;
+                    b = 0;
+                }
+                if (b == 0) {
+                    result = si5351_dev_set_multisynth_integer(dev, ms, pll_source, a);
                 } else {
-                    uint32_t c = 0xFFFFF;
-                    uint32_t b = (uint32_t)SI5351_DIVIDE_ROUND((uint64_t)(vco_freq % frequency) * c, frequency);
-                    result = si5351_set_multisynth_fractional(ms, pll_source, a, b, c);
+                    result = si5351_dev_set_multisynth_fractional(dev, ms, pll_source, a, b, c);
                 }
             }
             break;
@@ -427,33 +667,39 @@ si5351_err_t si5351_set_multisynth(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_
             if (vco_freq < (frequency * SI5351_MULTISYNTH_INT_0_TO_7_MIN)) result = SI5351_ERR_INVALID_ARG;
             if (!si5351_is_even_integer(a)) result = SI5351_ERR_INVALID_ARG;
 #endif
-            if ((vco_freq < a * (frequency + 1)) && (vco_freq > a * (frequency - 1))) result = SI5351_ERR_INVALID_ARG;
+            // integer only, the requested frequency has to be reachable within 1 Hz
+            if (!((vco_freq < a * (frequency + 1)) && (vco_freq > a * (frequency - 1)))) result = SI5351_ERR_INVALID_ARG;
             if (result != SI5351_OK) goto finish;
-            result = si5351_set_multisynth_integer(ms, pll_source, a);
+            result = si5351_dev_set_multisynth_integer(dev, ms, pll_source, a);
+            b = 0;
             break;
         default:
             result = SI5351_ERR_INVALID_ARG;
     }
+    if (result == SI5351_OK) {
+        dev->ms[ms].frequency = frequency;
+        dev->ms[ms].error = si5351_get_divider_error(si5351_get_vco_millihertz(dev, pll_source), (uint64_t)frequency * 1000, a, b, c);
+    }
 finish:
     return result;
 }
 
-si5351_err_t si5351_set_multisynth_integer(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint16_t a)
+si5351_err_t si5351_dev_set_multisynth_integer(si5351_t* dev, si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint16_t a)
 {
-    return si5351_set_multisynth_fractional(ms, pll_source, a, 0, 1);
+    return si5351_dev_set_multisynth_fractional(dev, ms, pll_source, a, 0, 1);
 }
 
-si5351_err_t si5351_set_multisynth_fractional(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint16_t a, uint32_t b, uint32_t c)
+si5351_err_t si5351_dev_set_multisynth_fractional(si5351_t* dev, si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint16_t a, uint32_t b, uint32_t c)
 {
     si5351_err_t result = SI5351_OK;
     if ((ms < SI5351_MS_CLK0) || (ms >= SI5351_MS_CLK_COUNT)) result = SI5351_ERR_INVALID_ARG;
     if ((pll_source < SI5351_PLLA) || (pll_source >= SI5351_PLL_COUNT)) result = SI5351_ERR_INVALID_ARG;
     if (result != SI5351_OK) goto finish;
-    if (!chip.pll[pll_source].configured) result = SI5351_ERR_NOT_INITIALISED;
+    if (!dev->pll[pll_source].configured) result = SI5351_ERR_NOT_INITIALISED;
     if ((c == 0) || (b >= c)) result = SI5351_ERR_INVALID_ARG;
     if (result != SI5351_OK) goto finish;
     bool set_div4 = false;
-    bool set_integer = false;
+    bool set_integer = (b == 0) && si5351_is_even_integer(a);
     switch (ms) {
         case SI5351_MS_CLK0:
         case SI5351_MS_CLK1:
@@ -496,37 +742,18 @@ si5351_err_t si5351_set_multisynth_fractional(si5351_ms_clk_reg_t ms, si5351_pll
     uint8_t data[SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH];
     if ((ms == SI5351_MS_CLK6) || (ms == SI5351_MS_CLK7)) {
         data[0] = (uint8_t)(a & 0xFF);
-        result = si5351_i2c_write(chip.i2c_address, ms_reg, data, 1);
+        result = si5351_write_regs(dev, ms_reg, data, 1);
     } else {
-        uint32_t p3 = c;
-        if (p3 & ~((uint32_t)SI5351_MULTISYNTH_P3_bm)) {
-            result = SI5351_ERR_INVALID_ARG;
-            goto finish;
-        }
-        uint32_t p1 = (uint32_t)128 * a + ((128 * b) / c) - 512;
-        if (p1 & ~((uint32_t)SI5351_MULTISYNTH_P1_bm)) {
-            result = SI5351_ERR_INVALID_ARG;
-            goto finish;
-        }
-        uint32_t p2 = 128 * b - c * ((128 * b) / c);
-        if (p2 & ~((uint32_t)SI5351_MULTISYNTH_P2_bm)) {
-            result = SI5351_ERR_INVALID_ARG;
-            goto finish;
-        }
-        data[0] = (uint8_t)((p3 >> 8) & 0xFF);
-        data[1] = (uint8_t)(p3 & 0xFF);
-        data[2] = (uint8_t)((p1 >> 16) & 0x03);
+        uint8_t r_div;
+        SI5351_GOTO_ON_ERROR(si5351_set_parameters(data, a, b, c), finish);
+        // the R divider shares the third register with P1 and MS_DIV4
+        SI5351_GOTO_ON_ERROR(si5351_read_reg(dev, ms_reg + 2, &r_div), finish);
+        data[2] |= r_div & SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm;
         if (set_div4) data[2] |= SI5351_MULTISYNTH0_PARAMETERS_MS_DIV4_bm;
-        data[3] = (uint8_t)((p1 >> 8) & 0xFF);
-        data[4] = (uint8_t)(p1 & 0xFF);
-        data[5] = (uint8_t)(((p3 >> 12) & 0xF0) | ((p2 >> 16) & 0x0F));
-        data[6] = (uint8_t)((p2 >> 8) & 0xFF);
-        data[7] = (uint8_t)(p2 & 0xFF);
-        result = si5351_i2c_write(chip.i2c_address, ms_reg, data, SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH);
-        if (set_integer && (result == SI5351_OK)) result = si5351_set_multisynth_mode_integer(ms, true);
+        result = si5351_write_regs(dev, ms_reg, data, SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH);
     }
     if (result == SI5351_OK) {
-        result = si5351_i2c_read(chip.i2c_address, si5351_clk_register[ms], data, 1);
+        result = si5351_read_regs(dev, si5351_clk_register[ms], data, 1);
         switch (pll_source) {
             case SI5351_PLLA:
                 *data &= ~(SI5351_CLK_CONTROL_MS_SRC_bm);
@@ -538,17 +765,28 @@ si5351_err_t si5351_set_multisynth_fractional(si5351_ms_clk_reg_t ms, si5351_pll
                 result = SI5351_ERR_INVALID_ARG;
                 goto finish;
         }
-        result = si5351_i2c_write(chip.i2c_address, si5351_clk_register[ms], data, 1);
+        // even integer dividers run in integer mode, lower jitter
+        if (ms <= SI5351_MS_CLK5) {
+            if (set_integer) {
+                *data |= SI5351_CLK_CONTROL_MS_INT_bm;
+            } else {
+                *data &= ~(SI5351_CLK_CONTROL_MS_INT_bm);
+            }
+        }
+        result = si5351_write_regs(dev, si5351_clk_register[ms], data, 1);
         if (result == SI5351_OK) {
-            chip.ms[ms].frequency = (uint32_t)SI5351_DIVIDE_ROUND((uint64_t)chip.pll[pll_source].frequency * c, c * a + b);
-            chip.ms[ms].configured = true;
+            uint64_t frequency = SI5351_UDIV64_ROUND(si5351_get_vco_millihertz(dev, pll_source) * c, (uint32_t)a * c + b);
+            dev->ms[ms].frequency = (uint32_t)SI5351_UDIV64_ROUND(frequency, 1000);
+            dev->ms[ms].error = (int32_t)(frequency - (uint64_t)dev->ms[ms].frequency * 1000);
+            dev->ms[ms].pll = pll_source;
+            dev->ms[ms].configured = true;
         }
     }
 finish:
     return result;
 }
 
-si5351_err_t si5351_set_multisynth_mode_integer(si5351_ms_clk_reg_t ms, bool integer)
+si5351_err_t si5351_dev_set_multisynth_mode_integer(si5351_t* dev, si5351_ms_clk_reg_t ms, bool integer)
 {
     si5351_err_t result;
     uint8_t data;
@@ -559,14 +797,14 @@ si5351_err_t si5351_set_multisynth_mode_integer(si5351_ms_clk_reg_t ms, bool int
         case SI5351_MS_CLK3:
         case SI5351_MS_CLK4:
         case SI5351_MS_CLK5:
-            result = si5351_i2c_read(chip.i2c_address, si5351_clk_register[ms], &data, 1);
+            result = si5351_read_reg(dev, si5351_clk_register[ms], &data);
             if (result == SI5351_OK) {
                 if (integer) {
                     data |= SI5351_CLK_CONTROL_MS_INT_bm;
                 } else {
                     data &= ~(SI5351_CLK_CONTROL_MS_INT_bm);
                 }
-                result = si5351_i2c_write(chip.i2c_address, si5351_clk_register[ms], &data, 1);
+                result = si5351_write_reg(dev, si5351_clk_register[ms], data);
             }
             break;
         default:
@@ -575,33 +813,177 @@ si5351_err_t si5351_set_multisynth_mode_integer(si5351_ms_clk_reg_t ms, bool int
     return result;
 }
 
-si5351_err_t si5351_get_multisynth_frequency(si5351_ms_clk_reg_t ms, uint32_t* frequency)
+si5351_err_t si5351_dev_get_multisynth_frequency(si5351_t* dev, si5351_ms_clk_reg_t ms, uint32_t* frequency)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((ms >= SI5351_MS_CLK0) && (ms < SI5351_MS_CLK_COUNT)) {
+        if (!dev->ms[ms].configured) {
+            result = SI5351_ERR_NOT_INITIALISED;
+            *frequency = 0;
+        } else {
+            *frequency = dev->ms[ms].frequency;
+        }
+    }
+    return result;
+}
+
+si5351_err_t si5351_dev_get_multisynth_error(si5351_t* dev, si5351_ms_clk_reg_t ms, int32_t* error)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((ms >= SI5351_MS_CLK0) && (ms < SI5351_MS_CLK_COUNT)) {
-        if (!chip.ms[ms].configured) {
+        result = SI5351_OK;
+        if (!dev->ms[ms].configured) {
+            result = SI5351_ERR_NOT_INITIALISED;
+            *error = 0;
+        } else {
+            *error = dev->ms[ms].error;
+        }
+    }
+    return result;
+}
+
+si5351_err_t si5351_dev_set_output_frequency(si5351_t* dev, si5351_ms_clk_reg_t clk, uint64_t frequency)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((clk < SI5351_MS_CLK0) || (clk >= SI5351_MS_CLK_COUNT) || (frequency == 0)) return result;
+    si5351_pll_reg_t pll_source = dev->ms[clk].configured ? dev->ms[clk].pll : SI5351_PLLA;
+    if (!dev->pll[pll_source].configured) return SI5351_ERR_NOT_INITIALISED;
+    uint64_t vco_freq = si5351_get_vco_millihertz(dev, pll_source);
+    uint16_t a;
+    uint32_t b, c;
+    uint8_t r;
+    // the smallest R divider that brings the multisynth into its range
+    for (r = 0; r <= (SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp); r++) {
+        if (si5351_get_output_divider(clk, vco_freq, frequency << r, &a, &b, &c)) break;
+    }
+    if (r > (SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp)) return result;
+    si5351_dev_begin(dev);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_multisynth_fractional(dev, clk, pll_source, a, b, c), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_clk_r_div(dev, clk, (si5351_clk_r_div_t)(r << SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp)), finish);
+finish:
+    if (result == SI5351_OK) {
+        result = si5351_dev_commit(dev);
+    } else {
+        si5351_dev_abort(dev);
+    }
+    return result;
+}
+
+si5351_err_t si5351_dev_get_output_frequency(si5351_t* dev, si5351_ms_clk_reg_t clk, uint64_t* frequency)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((clk >= SI5351_MS_CLK0) && (clk < SI5351_MS_CLK_COUNT)) {
+        result = SI5351_OK;
+        if (!dev->ms[clk].configured) {
             result = SI5351_ERR_NOT_INITIALISED;
             *frequency = 0;
         } else {
-            *frequency = chip.ms[ms].frequency;
+            uint8_t r = dev->ms[clk].r_div >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp;
+            *frequency = SI5351_DIVIDE_ROUND((uint64_t)dev->ms[clk].frequency * 1000 + dev->ms[clk].error, (uint64_t)1 << r);
         }
     }
     return result;
 }
 
-si5351_err_t si5351_set_fanout(bool clkin, bool xo, bool ms)
+si5351_err_t si5351_dev_set_vfo_frequency(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_pll_reg_t pll, uint64_t frequency)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((clk < SI5351_MS_CLK0) || (clk >= SI5351_MS_CLK_COUNT) || (frequency == 0)) return result;
+    if ((pll < SI5351_PLLA) || (pll >= SI5351_PLL_COUNT)) return result;
+    if (frequency > (uint64_t)SI5351_PLL_VCO_MAX * 1000 / SI5351_MULTISYNTH_INT_0_TO_5_DIV4) return result;
+    // PLLB of the B variant is the VCXO PLL, its fraction is fixed
+    if ((pll == SI5351_PLLB) && si5351_is_variant_b(dev->variant)) return result;
+    if (!dev->initialised) return SI5351_ERR_NOT_INITIALISED;
+    // the divider stays while the VCO can follow, otherwise a new even divider and R
+    uint16_t a;
+    uint8_t r = dev->ms[clk].r_div >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp;
+    bool keep = dev->ms[clk].configured && (dev->ms[clk].pll == pll)
+            && (si5351_get_integer_divider(dev, clk, &a) == SI5351_OK) && si5351_is_even_integer(a);
+    uint64_t vco_freq = keep ? (frequency << r) * a : 0;
+    if ((vco_freq < (uint64_t)SI5351_PLL_VCO_MIN * 1000) || (vco_freq > (uint64_t)SI5351_PLL_VCO_MAX * 1000)) {
+        keep = false;
+        if (!si5351_get_vfo_divider(clk, frequency, &a, &r)) return result;
+        vco_freq = (frequency << r) * a;
+    }
+    si5351_dev_begin(dev);
+    result = si5351_set_pll_vco_millihertz(dev, pll, vco_freq);
+    if ((result == SI5351_OK) && !keep) result = si5351_dev_set_multisynth_integer(dev, clk, pll, a);
+    if ((result == SI5351_OK) && !keep) result = si5351_dev_set_clk_r_div(dev, clk, (si5351_clk_r_div_t)(r << SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp));
+    if (result == SI5351_OK) {
+        result = si5351_dev_commit(dev);
+    } else {
+        si5351_dev_abort(dev);
+    }
+    if (result != SI5351_OK) goto finish;
+    if (keep) {
+        uint64_t ms_freq = SI5351_UDIV64_ROUND(si5351_get_vco_millihertz(dev, pll), a);
+        dev->ms[clk].frequency = (uint32_t)SI5351_UDIV64_ROUND(ms_freq, 1000);
+        dev->ms[clk].error = (int32_t)(ms_freq - (uint64_t)dev->ms[clk].frequency * 1000);
+    } else {
+        // a VCO jump with a new divider is followed by a reset of the PLL and its lock
+        SI5351_GOTO_ON_ERROR(si5351_dev_reset_single_pll(dev, pll), finish);
+        SI5351_GOTO_ON_ERROR(si5351_dev_wait_lock(dev, 1 << pll, SI5351_PLL_LOCK_TIME_ms * 1000UL, NULL), finish);
+    }
+finish:
+    return result;
+}
+
+si5351_err_t si5351_dev_set_pingpong_frequency(si5351_t* dev, si5351_ms_clk_reg_t clk, uint64_t frequency)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((clk < SI5351_MS_CLK0) || (clk >= SI5351_MS_CLK_COUNT) || (frequency == 0)) return result;
+    if (frequency > (uint64_t)SI5351_PLL_VCO_MAX * 1000 / SI5351_MULTISYNTH_INT_0_TO_5_DIV4) return result;
+    if (!dev->initialised || !dev->ms[clk].configured) return SI5351_ERR_NOT_INITIALISED;
+    si5351_pll_reg_t idle = (dev->ms[clk].pll == SI5351_PLLA) ? SI5351_PLLB : SI5351_PLLA;
+    for (uint8_t i = SI5351_MS_CLK0; i < SI5351_MS_CLK_COUNT; i++) {
+        if ((i != clk) && dev->ms[i].configured && (dev->ms[i].pll == idle)) return SI5351_ERR_INVALID_STATE;
+    }
+    // the running divider is kept when the idle VCO can reach the frequency with it
+    uint16_t a;
+    uint8_t r = dev->ms[clk].r_div >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp;
+    bool keep = (si5351_get_integer_divider(dev, clk, &a) == SI5351_OK) && si5351_is_even_integer(a);
+    uint64_t vco_freq = keep ? (frequency << r) * a : 0;
+    if ((vco_freq < (uint64_t)SI5351_PLL_VCO_MIN * 1000) || (vco_freq > (uint64_t)SI5351_PLL_VCO_MAX * 1000)) {
+        keep = false;
+        if (!si5351_get_vfo_divider(clk, frequency, &a, &r)) return result;
+        vco_freq = (frequency << r) * a;
+    }
+    SI5351_GOTO_ON_ERROR(si5351_set_pll_vco_millihertz(dev, idle, vco_freq), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_reset_single_pll(dev, idle), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_wait_lock(dev, 1 << idle, SI5351_PLL_LOCK_TIME_ms * 1000UL, NULL), finish);
+    // a new divider goes first, the control register holding MS_SRC is written after it
+    if (!keep) SI5351_GOTO_ON_ERROR(si5351_write_multisynth_integer(dev, clk, a, r), finish);
+    // the switch over is a single write of the clock control register
+    uint8_t control;
+    SI5351_GOTO_ON_ERROR(si5351_read_reg(dev, si5351_clk_register[clk], &control), finish);
+    if (idle == SI5351_PLLB) {
+        control |= SI5351_CLK_CONTROL_MS_SRC_bm;
+    } else {
+        control &= ~(SI5351_CLK_CONTROL_MS_SRC_bm);
+    }
+    if (clk <= SI5351_MS_CLK5) control |= SI5351_CLK_CONTROL_MS_INT_bm;
+    SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, si5351_clk_register[clk], control), finish);
+    uint64_t ms_freq = SI5351_UDIV64_ROUND(si5351_get_vco_millihertz(dev, idle), a);
+    dev->ms[clk].frequency = (uint32_t)SI5351_UDIV64_ROUND(ms_freq, 1000);
+    dev->ms[clk].error = (int32_t)(ms_freq - (uint64_t)dev->ms[clk].frequency * 1000);
+    dev->ms[clk].pll = idle;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_dev_set_fanout(si5351_t* dev, bool clkin, bool xo, bool ms)
 {
     si5351_err_t result;
     uint8_t data = 0x00;
-    if (clkin && si5351_is_variant_c(chip.variant)) data |= SI5351_FANOUT_ENABLE_CLKIN_bm;
+    if (clkin && si5351_is_variant_c(dev->variant)) data |= SI5351_FANOUT_ENABLE_CLKIN_bm;
     if (xo) data |= SI5351_FANOUT_ENABLE_XO_bm;
     if (ms) data |= SI5351_FANOUT_ENABLE_MS_bm;
-    result = si5351_i2c_write(chip.i2c_address, SI5351_FANOUT_ENABLE, &data, 1);
-    if (result == SI5351_OK) chip.fanout_bm = data;
+    result = si5351_write_reg(dev, SI5351_FANOUT_ENABLE, data);
+    if (result == SI5351_OK) dev->fanout_bm = data;
     return result;
 }
 
-si5351_err_t si5351_set_clk_disable_state(si5351_ms_clk_reg_t clk, si5351_clk_state_t state)
+si5351_err_t si5351_dev_set_clk_disable_state(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_clk_state_t state)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((clk < SI5351_MS_CLK0) || (clk >= SI5351_MS_CLK_COUNT)) goto finish;
@@ -614,30 +996,30 @@ si5351_err_t si5351_set_clk_disable_state(si5351_ms_clk_reg_t clk, si5351_clk_st
         clk = clk - 4;
     }
     uint8_t data;
-    result = si5351_i2c_read(chip.i2c_address, reg, &data, 1);
+    result = si5351_read_reg(dev, reg, &data);
     if (result == SI5351_OK) {
         data &= ~(SI5351_CLK0_TO_7_DISABLE_STATE_CLK_bm << (2 * clk));
         data |= ((state & SI5351_CLK0_TO_7_DISABLE_STATE_CLK_bm) << (2 * clk));
-        result = si5351_i2c_write(chip.i2c_address, reg, &data, 1);
+        result = si5351_write_reg(dev, reg, data);
     }
 finish:
     return result;
 }
 
-si5351_err_t si5351_set_clk(si5351_ms_clk_reg_t clk,
-                            bool powerup,
-                            bool inverted,
-                            si5351_clk_source_t clk_source,
-                            si5351_clk_r_div_t r,
-                            si5351_drv_strength_t drv_strength)
+si5351_err_t si5351_dev_set_clk(si5351_t* dev, si5351_ms_clk_reg_t clk,
+                                bool powerup,
+                                bool inverted,
+                                si5351_clk_source_t clk_source,
+                                si5351_clk_r_div_t r,
+                                si5351_drv_strength_t drv_strength)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((clk < SI5351_MS_CLK0) || (clk >= SI5351_MS_CLK_COUNT)) goto finish;
     if ((r & ~(SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm)) != 0) goto finish;
     if ((drv_strength & ~(SI5351_CLK_CONTROL_CLK_IDRV_bm)) != 0) goto finish;
-    if (si5351_is_clk_source_valid(clk, &clk_source)) {
+    if (si5351_is_clk_source_valid(dev, clk, &clk_source)) {
         uint8_t data;
-        result = si5351_i2c_read(chip.i2c_address, si5351_clk_register[clk], &data, 1);
+        result = si5351_read_reg(dev, si5351_clk_register[clk], &data);
         if (result == SI5351_OK) {
             data &= ~(SI5351_CLK_CONTROL_CLK_SRC_bm);
             data |= clk_source & SI5351_CLK_CONTROL_CLK_SRC_bm;
@@ -647,9 +1029,9 @@ si5351_err_t si5351_set_clk(si5351_ms_clk_reg_t clk,
             if (inverted) data |= SI5351_CLK_CONTROL_CLK_INV_bm;
             data &= ~(SI5351_CLK_CONTROL_CLK_PDN_bm);
             if (!powerup) data |= SI5351_CLK_CONTROL_CLK_PDN_bm;
-            result = si5351_i2c_write(chip.i2c_address, si5351_clk_register[clk], &data, 1);
+            result = si5351_write_reg(dev, si5351_clk_register[clk], data);
             if (result == SI5351_OK) {
-                result = si5351_set_clk_r_div(clk, r);
+                result = si5351_dev_set_clk_r_div(dev, clk, r);
             }
         }
     }
@@ -657,66 +1039,78 @@ finish:
     return result;
 }
 
-si5351_err_t si5351_set_clk_initial_phase(si5351_ms_clk_reg_t clk, uint8_t phase)
+si5351_err_t si5351_dev_set_clk_initial_phase(si5351_t* dev, si5351_ms_clk_reg_t clk, uint8_t phase)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((clk >= SI5351_MS_CLK0) && (clk <= SI5351_MS_CLK5)) {
         if (phase > SI5351_CLK_INITIAL_PHASE_OFFSET_bm) phase = SI5351_CLK_INITIAL_PHASE_OFFSET_bm;
-        result = si5351_i2c_write(chip.i2c_address, SI5351_CLK0_INITIAL_PHASE_OFFSET + (uint8_t)clk, &phase, 1);
+        result = si5351_write_reg(dev, SI5351_CLK0_INITIAL_PHASE_OFFSET + (uint8_t)clk, phase);
     }
     return result;
 }
 
-si5351_err_t si5351_set_clk_inverted(si5351_ms_clk_reg_t clk, bool inverted)
+si5351_err_t si5351_dev_set_clk_inverted(si5351_t* dev, si5351_ms_clk_reg_t clk, bool inverted)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((clk >= SI5351_MS_CLK0) && (clk < SI5351_MS_CLK_COUNT)) {
         uint8_t data;
-        result = si5351_i2c_read(chip.i2c_address, si5351_clk_register[clk], &data, 1);
+        result = si5351_read_reg(dev, si5351_clk_register[clk], &data);
         if (result == SI5351_OK) {
             if (inverted) {
                 data |= SI5351_CLK_CONTROL_CLK_INV_bm;
             } else {
                 data &= ~(SI5351_CLK_CONTROL_CLK_INV_bm);
             }
-            result = si5351_i2c_write(chip.i2c_address, si5351_clk_register[clk], &data, 1);
+            result = si5351_write_reg(dev, si5351_clk_register[clk], data);
         }
     }
     return result;
 }
 
-si5351_err_t si5351_set_clk_r_div(si5351_ms_clk_reg_t clk, si5351_clk_r_div_t r)
+si5351_err_t si5351_dev_set_clk_r_div(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_clk_r_div_t r)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((clk >= SI5351_MS_CLK0) && (clk < SI5351_MS_CLK_COUNT) && ((r & ~(SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm)) == 0)) {
         uint8_t data;
         uint8_t reg = si5351_multisynth_register[clk] + 2;
-        result = si5351_i2c_read(chip.i2c_address, reg, &data, 1);
+        uint8_t mask = SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm;
+        uint8_t value = r;
+        if (clk == SI5351_MS_CLK6) {
+            reg = SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER;
+            mask = SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R6_DIV_bm;
+            value = (r >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp) << SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R6_DIV_bp;
+        } else if (clk == SI5351_MS_CLK7) {
+            reg = SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER;
+            mask = SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R7_DIV_bm;
+            value = (r >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp) << SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R7_DIV_bp;
+        }
+        result = si5351_read_reg(dev, reg, &data);
         if (result == SI5351_OK) {
-            data &= ~(SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm);
-            data |= r;
-            result = si5351_i2c_write(chip.i2c_address, reg, &data, 1);
+            data &= ~mask;
+            data |= value;
+            result = si5351_write_reg(dev, reg, data);
+            if (result == SI5351_OK) dev->ms[clk].r_div = r;
         }
     }
     return result;
 }
 
-si5351_err_t si5351_set_clk_strength(si5351_ms_clk_reg_t clk, si5351_drv_strength_t drv_strength)
+si5351_err_t si5351_dev_set_clk_strength(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_drv_strength_t drv_strength)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((clk >= SI5351_MS_CLK0) && (clk < SI5351_MS_CLK_COUNT) && ((drv_strength & ~(SI5351_CLK_CONTROL_CLK_IDRV_bm)) == 0x00)) {
         uint8_t data;
-        result = si5351_i2c_read(chip.i2c_address, si5351_clk_register[clk], &data, 1);
+        result = si5351_read_reg(dev, si5351_clk_register[clk], &data);
         if (result == SI5351_OK) {
             data &= ~(SI5351_CLK_CONTROL_CLK_IDRV_bm);
             data |= drv_strength & SI5351_CLK_CONTROL_CLK_IDRV_bm;
-            result = si5351_i2c_write(chip.i2c_address, si5351_clk_register[clk], &data, 1);
+            result = si5351_write_reg(dev, si5351_clk_register[clk], data);
         }
     }
     return result;
 }
 
-bool si5351_is_clk_source_valid(si5351_ms_clk_reg_t clk, si5351_clk_source_t* clk_source)
+bool si5351_is_clk_source_valid(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_clk_source_t* clk_source)
 {
     bool result = false;
     if ((clk >= SI5351_MS_CLK0) && (clk < SI5351_MS_CLK_COUNT)) {
@@ -727,8 +1121,8 @@ bool si5351_is_clk_source_valid(si5351_ms_clk_reg_t clk, si5351_clk_source_t* cl
             case SI5351_MS_CLK1:
             case SI5351_MS_CLK2:
             case SI5351_MS_CLK3:
-                if (chip.fanout_bm & SI5351_FANOUT_ENABLE_MS_bm) {
-                    if ((*clk_source == SI5351_CLK_SOURCE_MS_0_OR_4) && chip.ms[SI5351_MS_CLK0].configured) result = true;
+                if (dev->fanout_bm & SI5351_FANOUT_ENABLE_MS_bm) {
+                    if ((*clk_source == SI5351_CLK_SOURCE_MS_0_OR_4) && dev->ms[SI5351_MS_CLK0].configured) result = true;
                 }
                 break;
             case SI5351_MS_CLK4:
@@ -737,104 +1131,425 @@ bool si5351_is_clk_source_valid(si5351_ms_clk_reg_t clk, si5351_clk_source_t* cl
             case SI5351_MS_CLK5:
             case SI5351_MS_CLK6:
             case SI5351_MS_CLK7:
-                if (chip.fanout_bm & SI5351_FANOUT_ENABLE_MS_bm) {
-                    if ((*clk_source == SI5351_CLK_SOURCE_MS_0_OR_4) && chip.ms[SI5351_MS_CLK4].configured) result = true;
+                if (dev->fanout_bm & SI5351_FANOUT_ENABLE_MS_bm) {
+                    if ((*clk_source == SI5351_CLK_SOURCE_MS_0_OR_4) && dev->ms[SI5351_MS_CLK4].configured) result = true;
                 }
                 break;
             default:
                 result = false;
         }
-        if ((*clk_source == SI5351_CLK_SOURCE_MS_X) && chip.ms[clk].configured) result = true;
+        if ((*clk_source == SI5351_CLK_SOURCE_MS_X) && dev->ms[clk].configured) result = true;
         if (*clk_source == SI5351_CLK_SOURCE_XTAL) {
-            if ((chip.fanout_bm & SI5351_FANOUT_ENABLE_XO_bm) && (chip.crystal_freq > 0)) result = true;
+            if ((dev->fanout_bm & SI5351_FANOUT_ENABLE_XO_bm) && (dev->crystal_freq > 0)) result = true;
         }
         if (*clk_source == SI5351_CLK_SOURCE_CLKIN) {
-            if ((chip.fanout_bm & SI5351_FANOUT_ENABLE_CLKIN_bm) && (chip.clkin_freq > 0)) result = true;
+            if ((dev->fanout_bm & SI5351_FANOUT_ENABLE_CLKIN_bm) && (dev->clkin_freq > 0)) result = true;
         }
     }
     return result;
 }
 
-si5351_err_t si5351_set_clk_source(si5351_ms_clk_reg_t clk, si5351_clk_source_t clk_source)
+si5351_err_t si5351_dev_set_clk_source(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_clk_source_t clk_source)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((clk >= SI5351_MS_CLK0) && (clk < SI5351_MS_CLK_COUNT)) {
-        if (si5351_is_clk_source_valid(clk, &clk_source)) {
+        if (si5351_is_clk_source_valid(dev, clk, &clk_source)) {
             uint8_t data;
-            result = si5351_i2c_read(chip.i2c_address, si5351_clk_register[clk], &data, 1);
+            result = si5351_read_reg(dev, si5351_clk_register[clk], &data);
             if (result == SI5351_OK) {
                 data &= ~(SI5351_CLK_CONTROL_CLK_SRC_bm);
                 data |= (clk_source & SI5351_CLK_CONTROL_CLK_SRC_bm);
-                result = si5351_i2c_write(chip.i2c_address, si5351_clk_register[clk], &data, 1);
+                result = si5351_write_reg(dev, si5351_clk_register[clk], data);
             }
         }
     }
     return result;
 }
 
-si5351_err_t si5351_set_clk_power_enable(si5351_ms_clk_reg_t clk, bool enable)
+si5351_err_t si5351_dev_set_clk_power_enable(si5351_t* dev, si5351_ms_clk_reg_t clk, bool enable)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((clk >= SI5351_MS_CLK0) && (clk < SI5351_MS_CLK_COUNT)) {
         uint8_t data;
-        result = si5351_i2c_read(chip.i2c_address, si5351_clk_register[clk], &data, 1);
+        result = si5351_read_reg(dev, si5351_clk_register[clk], &data);
         if (result == SI5351_OK) {
             if (enable) {
                 data &= ~(SI5351_CLK_CONTROL_CLK_PDN_bm);
             } else {
                 data |= SI5351_CLK_CONTROL_CLK_PDN_bm;
             }
-            result = si5351_i2c_write(chip.i2c_address, si5351_clk_register[clk], &data, 1);
+            result = si5351_write_reg(dev, si5351_clk_register[clk], data);
         }
     }
     return result;
 }
 
-si5351_err_t si5351_set_output_enable(si5351_ms_clk_reg_t clk, bool enable)
+si5351_err_t si5351_dev_set_output_enable(si5351_t* dev, si5351_ms_clk_reg_t clk, bool enable)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     if ((clk >= SI5351_MS_CLK0) && (clk < SI5351_MS_CLK_COUNT)) {
         uint8_t data;
-        result = si5351_i2c_read(chip.i2c_address, SI5351_OUTPUT_ENABLE_CONTROL, &data, 1);
+        result = si5351_read_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, &data);
         if (result == SI5351_OK) {
             if (enable) {
                 data &= ~(1 << clk);
             } else {
                 data |= (1 << clk);
             }
-            result = si5351_i2c_write(chip.i2c_address, SI5351_OUTPUT_ENABLE_CONTROL, &data, 1);
+            result = si5351_write_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, data);
         }
     }
     return result;
 }
 
-si5351_err_t si5351_set_powerdown()
+si5351_err_t si5351_dev_set_output_enable_mask(si5351_t* dev, uint8_t mask, bool enable)
 {
-    si5351_err_t result = SI5351_ERR_INVALID_STATE;
-    for (int i = SI5351_MS_CLK0; i < SI5351_MS_CLK_COUNT; i++) {
-        result = si5351_set_output_enable(i, false);
-        if (result != SI5351_OK) break;
-        result = si5351_set_clk_power_enable(i, false);
-        if (result != SI5351_OK) break;
+    si5351_err_t result;
+    uint8_t data;
+    // one bit per clock, set disables the output
+    result = si5351_read_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, &data);
+    if (result == SI5351_OK) {
+        if (enable) {
+            data &= ~mask;
+        } else {
+            data |= mask;
+        }
+        result = si5351_write_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, data);
     }
     return result;
 }
 
-si5351_err_t si5351_read_reg(uint8_t reg, uint8_t* data)
+si5351_err_t si5351_dev_set_clk_power_mask(si5351_t* dev, uint8_t mask, bool enable)
 {
-    si5351_err_t result;
-    result = si5351_i2c_read(chip.i2c_address, reg, data, 1);
+    si5351_err_t result = SI5351_OK;
+    uint8_t data[SI5351_MS_CLK_COUNT];
+    if (mask == 0x00) goto finish;
+    uint8_t first = 0;
+    uint8_t last = SI5351_MS_CLK_COUNT;
+    while (!(mask & (1 << first))) first++;
+    while (!(mask & (1 << (last - 1)))) last--;
+    SI5351_GOTO_ON_ERROR(si5351_read_regs(dev, si5351_clk_register[first], data, last - first), finish);
+    for (uint8_t i = first; i < last; i++) {
+        if (!(mask & (1 << i))) continue;
+        if (enable) {
+            data[i - first] &= ~(SI5351_CLK_CONTROL_CLK_PDN_bm);
+        } else {
+            data[i - first] |= SI5351_CLK_CONTROL_CLK_PDN_bm;
+        }
+    }
+    SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, si5351_clk_register[first], data, last - first), finish);
+finish:
     return result;
 }
 
-si5351_err_t si5351_write_reg(uint8_t reg, uint8_t data)
+si5351_err_t si5351_dev_set_clk_controls(si5351_t* dev, const uint8_t* controls)
 {
     si5351_err_t result;
-    result = si5351_i2c_write(chip.i2c_address, reg, &data, 1);
+    uint8_t data[SI5351_MS_CLK_COUNT];
+    // FB_INT of the PLLs shares CLK6_CONTROL and CLK7_CONTROL, it is kept
+    SI5351_GOTO_ON_ERROR(si5351_read_regs(dev, SI5351_CLK0_CONTROL, data, SI5351_MS_CLK_COUNT), finish);
+    for (uint8_t i = 0; i < SI5351_MS_CLK_COUNT; i++) {
+        if (i >= SI5351_MS_CLK6) {
+            data[i] = (controls[i] & ~(SI5351_CLK_CONTROL_FB_INT_bm)) | (data[i] & SI5351_CLK_CONTROL_FB_INT_bm);
+        } else {
+            data[i] = controls[i];
+        }
+    }
+    SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, SI5351_CLK0_CONTROL, data, SI5351_MS_CLK_COUNT), finish);
+    for (uint8_t i = 0; i < SI5351_MS_CLK_COUNT; i++) {
+        si5351_pll_reg_t pll = (data[i] & SI5351_CLK_CONTROL_MS_SRC_bm) ? SI5351_PLLB : SI5351_PLLA;
+        if (!dev->ms[i].configured || (dev->ms[i].pll == pll)) {
+            dev->ms[i].pll = pll;
+            continue;
+        }
+        // a multisynth moved to the other PLL, its frequency is decoded again from its divider
+        uint8_t divider[SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH];
+        if (i >= SI5351_MS_CLK6) {
+            SI5351_GOTO_ON_ERROR(si5351_read_reg(dev, si5351_multisynth_register[i], &(divider[0])), finish);
+            SI5351_GOTO_ON_ERROR(si5351_read_reg(dev, SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER, &(divider[1])), finish);
+        } else {
+            SI5351_GOTO_ON_ERROR(si5351_read_regs(dev, si5351_multisynth_register[i], divider, SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH), finish);
+        }
+        si5351_decode_multisynth(dev, (si5351_ms_clk_reg_t)i, data[i], divider);
+    }
+finish:
     return result;
 }
 
-si5351_err_t si5351_get_revision_id(si5351_variant_t variant, si5351_revision_t* rev_id)
+si5351_err_t si5351_dev_set_powerdown(si5351_t* dev)
+{
+    si5351_err_t result;
+    uint8_t data[SI5351_MS_CLK_COUNT];
+    // disable all outputs, then power down all output drivers in one burst
+    SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, 0xFF), finish);
+    SI5351_GOTO_ON_ERROR(si5351_read_regs(dev, SI5351_CLK0_CONTROL, data, SI5351_MS_CLK_COUNT), finish);
+    for (uint8_t i = 0; i < SI5351_MS_CLK_COUNT; i++) {
+        data[i] |= SI5351_CLK_CONTROL_CLK_PDN_bm;
+    }
+    SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, SI5351_CLK0_CONTROL, data, SI5351_MS_CLK_COUNT), finish);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_read_reg(si5351_t* dev, uint8_t reg, uint8_t* data)
+{
+    return si5351_read_regs(dev, reg, data, 1);
+}
+
+si5351_err_t si5351_write_reg(si5351_t* dev, uint8_t reg, uint8_t data)
+{
+    return si5351_write_regs(dev, reg, &data, 1);
+}
+
+si5351_err_t si5351_read_regs(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    si5351_err_t result;
+    bool shadowed = true;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!si5351_is_reg_shadowed(dev, reg + i)) {
+            shadowed = false;
+            break;
+        }
+    }
+    if (shadowed) {
+        memcpy(data, &(dev->regs[reg]), count);
+        return SI5351_OK;
+    }
+    result = si5351_read_burst(dev, reg, data, count);
+    if (result == SI5351_OK) {
+        si5351_cache_update(dev, reg, data, count);
+        // pending transaction writes take precedence over the chip contents
+        for (uint8_t i = 0; i < count; i++) {
+            if (si5351_is_reg_dirty(dev, reg + i)) data[i] = dev->regs[reg + i];
+        }
+    }
+    return result;
+}
+
+si5351_err_t si5351_write_regs(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    si5351_err_t result = SI5351_OK;
+    if (((uint16_t)reg + count) > SI5351_REGISTER_COUNT) return SI5351_ERR_INVALID_ARG;
+    if (dev->transaction > 0) {
+        for (uint8_t i = 0; i < count; i++) {
+            uint8_t r = reg + i;
+#if (SI5351_USE_REGISTER_CACHE == 1)
+            if (si5351_is_reg_cached(dev, r) && !si5351_is_reg_dirty(dev, r) && (dev->regs[r] == data[i])) continue;
+#endif
+            dev->regs[r] = data[i];
+            dev->regs_dirty[r / 8] |= (1 << (r % 8));
+        }
+    } else {
+        result = si5351_write_burst(dev, reg, data, count);
+        if (result == SI5351_OK) si5351_cache_update(dev, reg, data, count);
+    }
+    return result;
+}
+
+si5351_err_t si5351_read_burst(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    si5351_err_t result = SI5351_OK;
+    while (count > 0) {
+        uint8_t length = (count > SI5351_I2C_BURST_MAX) ? SI5351_I2C_BURST_MAX : count;
+        result = si5351_i2c_read(dev, reg, data, length);
+        if (result != SI5351_OK) break;
+        reg += length;
+        data += length;
+        count -= length;
+    }
+    return result;
+}
+
+si5351_err_t si5351_write_burst(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    si5351_err_t result = SI5351_OK;
+    while (count > 0) {
+        uint8_t length = (count > SI5351_I2C_BURST_MAX) ? SI5351_I2C_BURST_MAX : count;
+        result = si5351_i2c_write(dev, reg, data, length);
+        if (result != SI5351_OK) break;
+        reg += length;
+        data += length;
+        count -= length;
+    }
+    return result;
+}
+
+si5351_err_t si5351_write_bursts(si5351_t* dev, si5351_burst_t* bursts, uint8_t count)
+{
+    si5351_err_t result = SI5351_OK;
+    if (dev->bus->write_bursts != NULL) {
+        result = dev->bus->write_bursts(dev->bus->ctx, dev->i2c_address, bursts, count);
+    } else {
+        for (uint8_t i = 0; i < count; i++) {
+            result = si5351_i2c_write(dev, bursts[i].reg, bursts[i].data, bursts[i].count);
+            if (result != SI5351_OK) break;
+        }
+    }
+    if (result == SI5351_OK) {
+        for (uint8_t i = 0; i < count; i++) {
+            for (uint8_t reg = bursts[i].reg; reg < (bursts[i].reg + bursts[i].count); reg++) {
+                dev->regs_dirty[reg / 8] &= ~(1 << (reg % 8));
+                if (!si5351_is_reg_volatile(reg)) dev->regs_valid[reg / 8] |= (1 << (reg % 8));
+            }
+        }
+    }
+    return result;
+}
+
+si5351_err_t si5351_i2c_read(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    if (dev->bus == NULL) return SI5351_ERR_NOT_INITIALISED;
+    return dev->bus->read(dev->bus->ctx, dev->i2c_address & 0x7F, reg, data, count);
+}
+
+si5351_err_t si5351_i2c_write(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    if (dev->bus == NULL) return SI5351_ERR_NOT_INITIALISED;
+    return dev->bus->write(dev->bus->ctx, dev->i2c_address & 0x7F, reg, data, count);
+}
+
+si5351_err_t si5351_dev_begin(si5351_t* dev)
+{
+    if (dev->transaction == 0xFF) return SI5351_ERR_INVALID_STATE;
+    dev->transaction++;
+    return SI5351_OK;
+}
+
+// the staged writes never reach the chip, their registers are read again when needed
+si5351_err_t si5351_dev_abort(si5351_t* dev)
+{
+    if (dev->transaction == 0) return SI5351_ERR_INVALID_STATE;
+    dev->transaction--;
+    for (uint8_t i = 0; i < sizeof(dev->regs_dirty); i++) {
+        dev->regs_valid[i] &= ~(dev->regs_dirty[i]);
+        dev->regs_dirty[i] = 0x00;
+    }
+    return SI5351_OK;
+}
+
+si5351_err_t si5351_dev_commit(si5351_t* dev)
+{
+    si5351_err_t result = SI5351_OK;
+    si5351_burst_t bursts[SI5351_COMMIT_BURSTS_MAX];
+    uint8_t count = 0;
+    if (dev->transaction == 0) return SI5351_ERR_INVALID_STATE;
+    dev->transaction--;
+    if (dev->transaction > 0) return SI5351_OK;
+    uint8_t reg = 0;
+    while (reg < SI5351_REGISTER_COUNT) {
+        if (!si5351_is_reg_dirty(dev, reg)) {
+            reg++;
+            continue;
+        }
+        // extend the burst over dirty registers and short runs of known, unchanged ones
+        uint8_t last = reg;
+        uint8_t next = reg + 1;
+        while (next < SI5351_REGISTER_COUNT) {
+            if (si5351_is_reg_dirty(dev, next)) {
+                last = next;
+            } else if (((next - last) > SI5351_I2C_BURST_GAP_MAX) || !si5351_is_reg_bridgeable(dev, next)) {
+                break;
+            }
+            next++;
+        }
+        while (reg <= last) {
+            uint8_t length = last - reg + 1;
+            if (length > SI5351_I2C_BURST_MAX) length = SI5351_I2C_BURST_MAX;
+            bursts[count].reg = reg;
+            bursts[count].count = length;
+            bursts[count].data = &(dev->regs[reg]);
+            count++;
+            reg += length;
+            if (count == SI5351_COMMIT_BURSTS_MAX) {
+                SI5351_GOTO_ON_ERROR(si5351_write_bursts(dev, bursts, count), finish);
+                count = 0;
+            }
+        }
+    }
+    if (count > 0) result = si5351_write_bursts(dev, bursts, count);
+finish:
+    if (result != SI5351_OK) {
+        // the chip contents of unsent registers are unknown now
+        for (uint8_t i = 0; i < sizeof(dev->regs_dirty); i++) {
+            dev->regs_valid[i] &= ~(dev->regs_dirty[i]);
+            dev->regs_dirty[i] = 0x00;
+        }
+    }
+    return result;
+}
+
+void si5351_cache_update(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t r = reg + i;
+        if ((r >= SI5351_REGISTER_COUNT) || si5351_is_reg_volatile(r) || si5351_is_reg_dirty(dev, r)) continue;
+        dev->regs[r] = data[i];
+        dev->regs_valid[r / 8] |= (1 << (r % 8));
+    }
+}
+
+void si5351_cache_invalidate(si5351_t* dev)
+{
+    memset(dev->regs_valid, 0x00, sizeof(dev->regs_valid));
+    memset(dev->regs_dirty, 0x00, sizeof(dev->regs_dirty));
+    dev->transaction = 0;
+}
+
+bool si5351_is_reg_cached(si5351_t* dev, uint8_t reg)
+{
+    bool result = false;
+    if (reg < SI5351_REGISTER_COUNT) {
+        if (dev->regs_valid[reg / 8] & (1 << (reg % 8))) result = true;
+    }
+    return result;
+}
+
+bool si5351_is_reg_dirty(si5351_t* dev, uint8_t reg)
+{
+    bool result = false;
+    if (reg < SI5351_REGISTER_COUNT) {
+        if (dev->regs_dirty[reg / 8] & (1 << (reg % 8))) result = true;
+    }
+    return result;
+}
+
+bool si5351_is_reg_shadowed(si5351_t* dev, uint8_t reg)
+{
+    if (si5351_is_reg_dirty(dev, reg)) return true;
+#if (SI5351_USE_REGISTER_CACHE == 1)
+    return si5351_is_reg_cached(dev, reg);
+#else
+    return false;
+#endif
+}
+
+bool si5351_is_reg_bridgeable(si5351_t* dev, uint8_t reg)
+{
+#if (SI5351_USE_REGISTER_CACHE == 1)
+    return si5351_is_reg_cached(dev, reg) && !si5351_is_reg_volatile(reg);
+#else
+    (void)dev;
+    (void)reg;
+    return false;
+#endif
+}
+
+bool si5351_is_reg_volatile(uint8_t reg)
+{
+    bool result;
+    switch (reg) {
+        case SI5351_DEVICE_STATUS:
+        case SI5351_INTERRUPT_STATUS_STICKY:
+        case SI5351_PLL_RESET:
+            result = true;
+            break;
+        default:
+            result = false;
+    }
+    return result;
+}
+
+si5351_err_t si5351_get_revision_id(si5351_variant_t variant, si5351_revision_t* rev_id)
 {
     si5351_err_t result = SI5351_ERR_INVALID_ARG;
     switch (variant) {
@@ -907,3 +1622,513 @@ bool si5351_is_even_integer(uint16_t val)
     return result;
 }
 
+void si5351_get_best_fraction(uint64_t num, uint64_t den, uint32_t c_max, uint32_t* b, uint32_t* c)
+{
+    // best rational approximation b / c of num / den < 1 with c <= c_max,
+    // continued fraction convergents and the last semiconvergent
+    uint64_t p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    uint64_t n = num, d = den;
+    while (d != 0) {
+        // 32-bit division as soon as the remainders fit, the usual case
+        uint64_t k = (((n | d) >> 32) == 0) ? (uint32_t)n / (uint32_t)d : n / d;
+        uint64_t q2 = q0 + k * q1;
+        if (q2 > c_max) break;
+        uint64_t p2 = p0 + k * p1;
+        p0 = p1;
+        q0 = q1;
+        p1 = p2;
+        q1 = q2;
+        uint64_t t = n - k * d;
+        n = d;
+        d = t;
+    }
+    if (d != 0) {
+        uint64_t k = (uint32_t)(c_max - q0) / (uint32_t)q1;
+        uint64_t ps = p0 + k * p1;
+        uint64_t qs = q0 + k * q1;
+        // |num / den - p / q| * den * q = |num * q - p * den|, compare across the two denominators
+        uint64_t es = (num * qs > ps * den) ? num * qs - ps * den : ps * den - num * qs;
+        uint64_t e1 = (num * q1 > p1 * den) ? num * q1 - p1 * den : p1 * den - num * q1;
+        if (es * q1 < e1 * qs) {
+            p1 = ps;
+            q1 = qs;
+        }
+    }
+    *b = (uint32_t)p1;
+    *c = (uint32_t)q1;
+}
+
+int32_t si5351_get_divider_error(uint64_t vco_freq, uint64_t frequency, uint32_t a, uint32_t b, uint32_t c)
+{
+    // vco / (a + b / c) - frequency, both and the result in millihertz
+    uint32_t n = a * c + b;
+    int64_t error = (int64_t)(vco_freq * c) - (int64_t)(frequency * n);
+    // rounded half away from zero
+    if (error < 0) return -(int32_t)SI5351_UDIV64_ROUND((uint64_t)-error, n);
+    return (int32_t)SI5351_UDIV64_ROUND((uint64_t)error, n);
+}
+
+int32_t si5351_get_vco_error(uint32_t in_frequency, uint32_t frequency, uint32_t a, uint32_t b, uint32_t c)
+{
+    // in * (a + b / c) - frequency, millihertz
+    int64_t error = ((int64_t)in_frequency * a - frequency) * 1000;
+    return (int32_t)(error + (int64_t)SI5351_UDIV64_ROUND((uint64_t)in_frequency * 1000 * b, c));
+}
+
+uint64_t si5351_get_vco_millihertz(si5351_t* dev, si5351_pll_reg_t pll)
+{
+    return (uint64_t)dev->pll[pll].frequency * 1000 + dev->pll[pll].error;
+}
+
+bool si5351_get_output_divider(si5351_ms_clk_reg_t clk, uint64_t vco_freq, uint64_t frequency, uint16_t* a, uint32_t* b, uint32_t* c)
+{
+    // vco_freq and frequency in mHz
+    uint64_t div = vco_freq / frequency;
+    *b = 0;
+    *c = 1;
+    if ((clk == SI5351_MS_CLK6) || (clk == SI5351_MS_CLK7)) {
+        // integer only, the nearest even divider
+        div = (vco_freq + frequency) / (2 * frequency) * 2;
+        if ((div < SI5351_MULTISYNTH_INT_0_TO_7_MIN) || (div > SI5351_MULTISYNTH_INT_0_TO_7_MAX)) return false;
+        *a = (uint16_t)div;
+        return true;
+    }
+    if ((div < SI5351_MULTISYNTH_FRAC_0_TO_5_MIN) && ((vco_freq % frequency) == 0)
+            && ((div == SI5351_MULTISYNTH_INT_0_TO_5_DIV4) || (div == SI5351_MULTISYNTH_INT_0_TO_7_MIN))) {
+        *a = (uint16_t)div;
+        return true;
+    }
+    if ((div < SI5351_MULTISYNTH_FRAC_0_TO_5_MIN) || (div > SI5351_MULTISYNTH_FRAC_0_TO_5_MAX)) return false;
+    si5351_get_best_fraction(vco_freq % frequency, frequency, SI5351_FRACTION_C_MAX, b, c);
+    if (*b == *c) {
+        div++;
+        *b = 0;
+        *c = 1;
+    }
+    if ((div == SI5351_MULTISYNTH_FRAC_0_TO_5_MAX) && (*b > 0)) return false;
+    if (div > SI5351_MULTISYNTH_FRAC_0_TO_5_MAX) return false;
+    *a = (uint16_t)div;
+    return true;
+}
+
+si5351_err_t si5351_get_integer_divider(si5351_t* dev, si5351_ms_clk_reg_t clk, uint16_t* a)
+{
+    si5351_err_t result;
+    uint8_t data[SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH];
+    if ((clk == SI5351_MS_CLK6) || (clk == SI5351_MS_CLK7)) {
+        SI5351_GOTO_ON_ERROR(si5351_read_reg(dev, si5351_multisynth_register[clk], data), finish);
+        *a = data[0];
+    } else {
+        SI5351_GOTO_ON_ERROR(si5351_read_regs(dev, si5351_multisynth_register[clk], data, SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH), finish);
+        if (data[2] & SI5351_MULTISYNTH0_PARAMETERS_MS_DIV4_bm) {
+            *a = SI5351_MULTISYNTH_INT_0_TO_5_DIV4;
+        } else {
+            uint32_t p1, p2, p3;
+            si5351_get_parameters(data, &p1, &p2, &p3);
+            // retuning the PLL under a fractional multisynth would move its fraction too
+            if ((p2 != 0) || (((p1 + 512) % 128) != 0)) {
+                result = SI5351_ERR_INVALID_STATE;
+                goto finish;
+            }
+            *a = (uint16_t)((p1 + 512) / 128);
+        }
+    }
+finish:
+    return result;
+}
+
+si5351_err_t si5351_set_pll_vco_millihertz(si5351_t* dev, si5351_pll_reg_t pll, uint64_t vco_freq)
+{
+    uint32_t in_frequency = si5351_get_pll_source_frequency(dev, pll);
+    if ((in_frequency < SI5351_PLL_CLKIN_MIN) || (in_frequency > SI5351_PLL_CLKIN_MAX)) return SI5351_ERR_INVALID_ARG;
+    uint64_t reference = (uint64_t)in_frequency * 1000;
+    uint8_t a = (uint8_t)(vco_freq / reference);
+    uint32_t b, c;
+    if ((pll == SI5351_PLLB) && si5351_is_variant_b(dev->variant)) {
+        c = SI5351_PLLB_VARIANT_B_C;
+        b = (uint32_t)SI5351_DIVIDE_ROUND((vco_freq % reference) * c, reference);
+    } else {
+        si5351_get_best_fraction(vco_freq % reference, reference, SI5351_FRACTION_C_MAX, &b, &c);
+    }
+    if (b == c) {
+        a++;
+        b = 0;
+    }
+    return si5351_dev_set_pll_vco_fractional(dev, pll, a, b, c);
+}
+
+si5351_err_t si5351_write_multisynth_integer(si5351_t* dev, si5351_ms_clk_reg_t clk, uint16_t a, uint8_t r)
+{
+    // the parameter block and the R divider in one commit, MS_SRC and MS_INT are left as they are
+    si5351_err_t result;
+    si5351_clk_r_div_t r_div = (si5351_clk_r_div_t)(r << SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp);
+    uint8_t data[SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH];
+    si5351_dev_begin(dev);
+    if ((clk == SI5351_MS_CLK6) || (clk == SI5351_MS_CLK7)) {
+        data[0] = (uint8_t)(a & 0xFF);
+        SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, si5351_multisynth_register[clk], data, 1), finish);
+        SI5351_GOTO_ON_ERROR(si5351_dev_set_clk_r_div(dev, clk, r_div), finish);
+    } else {
+        SI5351_GOTO_ON_ERROR(si5351_set_parameters(data, a, 0, 1), finish);
+        data[2] |= r_div;
+        if (a == SI5351_MULTISYNTH_INT_0_TO_5_DIV4) data[2] |= SI5351_MULTISYNTH0_PARAMETERS_MS_DIV4_bm;
+        SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, si5351_multisynth_register[clk], data, SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH), finish);
+    }
+finish:
+    if (result == SI5351_OK) {
+        result = si5351_dev_commit(dev);
+    } else {
+        si5351_dev_abort(dev);
+    }
+    if (result == SI5351_OK) dev->ms[clk].r_div = r_div;
+    return result;
+}
+
+void si5351_add_lock_time(si5351_t* dev, si5351_pll_reg_t pll, uint32_t usec)
+{
+    // bin 0 below SI5351_LOCK_HISTOGRAM_MIN_usec, each next bin twice as wide, the last one open
+    uint8_t bin = 0;
+    uint32_t limit = SI5351_LOCK_HISTOGRAM_MIN_usec;
+    while ((bin < SI5351_LOCK_HISTOGRAM_BINS - 1) && (usec >= limit)) {
+        bin++;
+        limit <<= 1;
+    }
+    if (dev->lock_histogram[pll][bin] < UINT16_MAX) dev->lock_histogram[pll][bin]++;
+}
+
+bool si5351_get_vfo_divider(si5351_ms_clk_reg_t clk, uint64_t frequency, uint16_t* a, uint8_t* r)
+{
+    // frequency in mHz, the even divider nearest to the middle of the VCO range leaves the most room to retune
+    bool ms67 = (clk == SI5351_MS_CLK6) || (clk == SI5351_MS_CLK7);
+    uint64_t div_min = ms67 ? SI5351_MULTISYNTH_INT_0_TO_7_MIN : SI5351_MULTISYNTH_INT_0_TO_5_DIV4;
+    uint64_t div_max = ms67 ? SI5351_MULTISYNTH_INT_0_TO_7_MAX : SI5351_MULTISYNTH_FRAC_0_TO_5_MAX;
+    for (*r = 0; *r <= (SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp); (*r)++) {
+        uint64_t f = frequency << *r;
+        uint64_t low = ((uint64_t)SI5351_PLL_VCO_MIN * 1000 + 2 * f - 1) / (2 * f) * 2;
+        uint64_t high = (uint64_t)SI5351_PLL_VCO_MAX * 1000 / (2 * f) * 2;
+        uint64_t div = ((uint64_t)(SI5351_PLL_VCO_MIN + SI5351_PLL_VCO_MAX) * 500 + f) / (2 * f) * 2;
+        if (low < div_min) low = div_min;
+        if (high > div_max) high = div_max;
+        if (low > high) continue;
+        if (div < low) div = low;
+        if (div > high) div = high;
+        *a = (uint16_t)div;
+        return true;
+    }
+    return false;
+}
+
+uint64_t si5351_udiv64(uint64_t n, uint32_t d)
+{
+#if (SI5351_USE_SOFT_DIVISION == 1)
+    // the high word by a 32-bit division, the low word in 32 shift-subtract steps
+    uint32_t high = (uint32_t)(n >> 32);
+    uint32_t quotient = high / d;
+    uint32_t remainder = high - quotient * d;
+    uint32_t low = (uint32_t)n;
+    for (uint8_t i = 0; i < 32; i++) {
+        bool carry = (remainder & 0x80000000UL) != 0;
+        remainder = (remainder << 1) | (low >> 31);
+        low <<= 1;
+        if (carry || (remainder >= d)) {
+            remainder -= d;
+            low |= 1;
+        }
+    }
+    return ((uint64_t)quotient << 32) | low;
+#else
+    return n / d;
+#endif
+}
+
+uint64_t si5351_scale(uint64_t x, uint32_t k, uint64_t n)
+{
+    // x * k / n rounded, the product may not fit in 64 bits (x < 2^44, k < 2^28, n < 2^40)
+    uint64_t h = (x >> 20) * k;
+    uint64_t r = ((h % n) << 20) + (x & 0xFFFFF) * k + n / 2;
+    return ((h / n) << 20) + r / n;
+}
+
+
+si5351_err_t si5351_init(const si5351_bus_t* bus,
+                         si5351_variant_t variant,
+                         uint8_t i2c_address,
+                         si5351_crystal_freq_t xtal_frequency,
+                         uint32_t clkin_frequency,
+                         bool unbreakable)
+{
+    return si5351_dev_init(&chip, bus, variant, i2c_address, xtal_frequency, clkin_frequency, unbreakable);
+}
+
+si5351_err_t si5351_get_status(uint8_t* status)
+{
+    return si5351_dev_get_status(&chip, status);
+}
+
+si5351_err_t si5351_set_crystal_load(si5351_crystal_load_t cap)
+{
+    return si5351_dev_set_crystal_load(&chip, cap);
+}
+
+si5351_err_t si5351_set_pll_source(si5351_pll_source_t plla, si5351_pll_source_t pllb, si5351_clkin_divider_t divider)
+{
+    return si5351_dev_set_pll_source(&chip, plla, pllb, divider);
+}
+
+si5351_err_t si5351_set_pll_vco(si5351_pll_reg_t pll, uint32_t frequency)
+{
+    return si5351_dev_set_pll_vco(&chip, pll, frequency);
+}
+
+si5351_err_t si5351_set_pll_vco_integer(si5351_pll_reg_t pll, uint8_t a)
+{
+    return si5351_dev_set_pll_vco_integer(&chip, pll, a);
+}
+
+si5351_err_t si5351_set_pll_vco_fractional(si5351_pll_reg_t pll, uint8_t a, uint32_t b, uint32_t c)
+{
+    return si5351_dev_set_pll_vco_fractional(&chip, pll, a, b, c);
+}
+
+si5351_err_t si5351_set_pll_mode_integer(si5351_pll_reg_t pll, bool integer)
+{
+    return si5351_dev_set_pll_mode_integer(&chip, pll, integer);
+}
+
+si5351_err_t si5351_get_pll_frequency(si5351_pll_reg_t pll, uint32_t* frequency)
+{
+    return si5351_dev_get_pll_frequency(&chip, pll, frequency);
+}
+
+si5351_err_t si5351_get_pll_error(si5351_pll_reg_t pll, int32_t* error)
+{
+    return si5351_dev_get_pll_error(&chip, pll, error);
+}
+
+si5351_err_t si5351_reset_pll()
+{
+    return si5351_dev_reset_pll(&chip);
+}
+
+si5351_err_t si5351_reset_single_pll(si5351_pll_reg_t pll)
+{
+    return si5351_dev_reset_single_pll(&chip, pll);
+}
+
+si5351_err_t si5351_wait_lock(uint8_t pll_mask, uint32_t timeout_usec, uint32_t* lock_usec)
+{
+    return si5351_dev_wait_lock(&chip, pll_mask, timeout_usec, lock_usec);
+}
+
+si5351_err_t si5351_get_lock_histogram(si5351_pll_reg_t pll, uint16_t* bins, uint16_t* timeouts)
+{
+    return si5351_dev_get_lock_histogram(&chip, pll, bins, timeouts);
+}
+
+void si5351_clear_lock_histogram()
+{
+    si5351_dev_clear_lock_histogram(&chip);
+}
+
+si5351_err_t si5351_set_multisynth(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint32_t frequency)
+{
+    return si5351_dev_set_multisynth(&chip, ms, pll_source, frequency);
+}
+
+si5351_err_t si5351_set_multisynth_integer(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint16_t a)
+{
+    return si5351_dev_set_multisynth_integer(&chip, ms, pll_source, a);
+}
+
+si5351_err_t si5351_set_multisynth_fractional(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint16_t a, uint32_t b, uint32_t c)
+{
+    return si5351_dev_set_multisynth_fractional(&chip, ms, pll_source, a, b, c);
+}
+
+si5351_err_t si5351_set_multisynth_mode_integer(si5351_ms_clk_reg_t ms, bool integer)
+{
+    return si5351_dev_set_multisynth_mode_integer(&chip, ms, integer);
+}
+
+si5351_err_t si5351_get_multisynth_frequency(si5351_ms_clk_reg_t ms, uint32_t* frequency)
+{
+    return si5351_dev_get_multisynth_frequency(&chip, ms, frequency);
+}
+
+si5351_err_t si5351_get_multisynth_error(si5351_ms_clk_reg_t ms, int32_t* error)
+{
+    return si5351_dev_get_multisynth_error(&chip, ms, error);
+}
+
+si5351_err_t si5351_set_output_frequency(si5351_ms_clk_reg_t clk, uint64_t frequency)
+{
+    return si5351_dev_set_output_frequency(&chip, clk, frequency);
+}
+
+si5351_err_t si5351_get_output_frequency(si5351_ms_clk_reg_t clk, uint64_t* frequency)
+{
+    return si5351_dev_get_output_frequency(&chip, clk, frequency);
+}
+
+si5351_err_t si5351_set_vfo_frequency(si5351_ms_clk_reg_t clk, si5351_pll_reg_t pll, uint64_t frequency)
+{
+    return si5351_dev_set_vfo_frequency(&chip, clk, pll, frequency);
+}
+
+si5351_err_t si5351_set_pingpong_frequency(si5351_ms_clk_reg_t clk, uint64_t frequency)
+{
+    return si5351_dev_set_pingpong_frequency(&chip, clk, frequency);
+}
+
+si5351_err_t si5351_set_fanout(bool clkin, bool xtal, bool ms)
+{
+    return si5351_dev_set_fanout(&chip, clkin, xtal, ms);
+}
+
+si5351_err_t si5351_set_clk_disable_state(si5351_ms_clk_reg_t clk, si5351_clk_state_t state)
+{
+    return si5351_dev_set_clk_disable_state(&chip, clk, state);
+}
+
+si5351_err_t si5351_set_clk(si5351_ms_clk_reg_t clk,
+                            bool powerup,
+                            bool inverted,
+                            si5351_clk_source_t clk_source,
+                            si5351_clk_r_div_t r,
+                            si5351_drv_strength_t drv_strength)
+{
+    return si5351_dev_set_clk(&chip, clk, powerup, inverted, clk_source, r, drv_strength);
+}
+
+si5351_err_t si5351_set_clk_initial_phase(si5351_ms_clk_reg_t clk, uint8_t phase)
+{
+    return si5351_dev_set_clk_initial_phase(&chip, clk, phase);
+}
+
+si5351_err_t si5351_set_clk_inverted(si5351_ms_clk_reg_t clk, bool inverted)
+{
+    return si5351_dev_set_clk_inverted(&chip, clk, inverted);
+}
+
+si5351_err_t si5351_set_clk_r_div(si5351_ms_clk_reg_t clk, si5351_clk_r_div_t r)
+{
+    return si5351_dev_set_clk_r_div(&chip, clk, r);
+}
+
+si5351_err_t si5351_set_clk_strength(si5351_ms_clk_reg_t clk, si5351_drv_strength_t drv_strength)
+{
+    return si5351_dev_set_clk_strength(&chip, clk, drv_strength);
+}
+
+si5351_err_t si5351_set_clk_source(si5351_ms_clk_reg_t clk, si5351_clk_source_t clk_source)
+{
+    return si5351_dev_set_clk_source(&chip, clk, clk_source);
+}
+
+si5351_err_t si5351_set_clk_power_enable(si5351_ms_clk_reg_t clk, bool enable)
+{
+    return si5351_dev_set_clk_power_enable(&chip, clk, enable);
+}
+
+si5351_err_t si5351_set_output_enable(si5351_ms_clk_reg_t clk, bool enable)
+{
+    return si5351_dev_set_output_enable(&chip, clk, enable);
+}
+
+si5351_err_t si5351_set_output_enable_mask(uint8_t mask, bool enable)
+{
+    return si5351_dev_set_output_enable_mask(&chip, mask, enable);
+}
+
+si5351_err_t si5351_set_clk_power_mask(uint8_t mask, bool enable)
+{
+    return si5351_dev_set_clk_power_mask(&chip, mask, enable);
+}
+
+si5351_err_t si5351_set_clk_controls(const uint8_t* controls)
+{
+    return si5351_dev_set_clk_controls(&chip, controls);
+}
+
+si5351_err_t si5351_set_powerdown()
+{
+    return si5351_dev_set_powerdown(&chip);
+}
+
+si5351_err_t si5351_begin()
+{
+    return si5351_dev_begin(&chip);
+}
+
+si5351_err_t si5351_commit()
+{
+    return si5351_dev_commit(&chip);
+}
+
+si5351_err_t si5351_abort()
+{
+    return si5351_dev_abort(&chip);
+}
+
+
+#if ARDUINO >= 100
+si5351_err_t si5351_arduino_read(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    return (si5351_err_t)i2c_master_read_reg(i2c_addr, reg, data, count);
+}
+
+si5351_err_t si5351_arduino_write(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    return (si5351_err_t)i2c_master_write_reg(i2c_addr, reg, data, count);
+}
+
+void si5351_arduino_delay_msec(void* ctx, uint32_t msec)
+{
+    delay(msec);
+}
+
+uint32_t si5351_arduino_get_time_usec(void* ctx)
+{
+    return micros();
+}
+
+const si5351_bus_t si5351_bus_arduino = {
+        .read = si5351_arduino_read,
+        .write = si5351_arduino_write,
+        .write_bursts = NULL,
+        .delay_msec = si5351_arduino_delay_msec,
+        .get_time_usec = si5351_arduino_get_time_usec,
+        .ctx = NULL,
+};
+
+#elif defined(ESP_PLATFORM)
+si5351_err_t si5351_espidf_read(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    return (si5351_err_t)i2c_master_read_reg(i2c_addr, reg, data, count);
+}
+
+si5351_err_t si5351_espidf_write(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    return (si5351_err_t)i2c_master_write_reg(i2c_addr, reg, data, count);
+}
+
+void si5351_espidf_delay_msec(void* ctx, uint32_t msec)
+{
+    // the first tick can come at once, one more keeps a delay shorter than a tick from being dropped
+    vTaskDelay(pdMS_TO_TICKS(msec) + 1);
+}
+
+uint32_t si5351_espidf_get_time_usec(void* ctx)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+const si5351_bus_t si5351_bus_espidf = {
+        .read = si5351_espidf_read,
+        .write = si5351_espidf_write,
+        .write_bursts = NULL,
+        .delay_msec = si5351_espidf_delay_msec,
+        .get_time_usec = si5351_espidf_get_time_usec,
+        .ctx = NULL,
+};
+#endif
@@ -15,6 +15,7 @@
 
 #include "si5351_def.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 
@@ -25,6 +26,68 @@ extern "C" {
 
 #define SI5351_DEFAULT_CLK_POWERDOWN        1
 #define SI5351_ALLOW_OVERCLOCKING           0
+// Serve read-modify-write cycles from the register shadow.
+// Set to 0 if another I2C master also writes to the chip.
+#ifndef SI5351_USE_REGISTER_CACHE
+#define SI5351_USE_REGISTER_CACHE           1
+#endif
+// Longest auto-increment burst handed to the bus driver (Arduino Wire buffer is 32 bytes).
+#define SI5351_I2C_BURST_MAX                31
+// Unchanged cached registers a transaction may resend to join two bursts.
+#define SI5351_I2C_BURST_GAP_MAX            2
+// Status poll interval of si5351_wait_lock(), 1 ms when the bus has no get_time_usec().
+// Whole milliseconds of it are spent in delay_msec(), the rest spins on get_time_usec().
+#ifndef SI5351_LOCK_POLL_usec
+#define SI5351_LOCK_POLL_usec               100
+#endif
+// Lock time histogram per PLL: bin 0 below SI5351_LOCK_HISTOGRAM_MIN_usec,
+// each next bin twice as wide, the last one open.
+#define SI5351_LOCK_HISTOGRAM_BINS          8
+#define SI5351_LOCK_HISTOGRAM_MIN_usec      128
+// Divide 64-bit values by 32-bit divisors in shift-subtract steps instead of the
+// compiler's 64-bit division. Off by default, bench/si5351_cycles.c checks both
+// backends give the same registers.
+#ifndef SI5351_USE_SOFT_DIVISION
+#define SI5351_USE_SOFT_DIVISION            0
+#endif
+
+#if ARDUINO >= 100
+#include <Arduino.h>
+#include "i2c_master.h"
+
+typedef uint8_t si5351_err_t;
+
+#define SI5351_OK                       0x00
+#define SI5351_ERR_FAIL                 0x10
+#define SI5351_ERR_TIMEOUT              0x11
+#define SI5351_ERR_INVALID_STATE        0x12
+#define SI5351_ERR_NOT_INITIALISED      0x13
+#define SI5351_ERR_INVALID_ARG          0x14
+
+#elif defined(ESP_PLATFORM)
+#include "i2c_master.h"
+#include "esp_err.h"
+
+typedef esp_err_t si5351_err_t;
+
+#define SI5351_OK                       ESP_OK
+#define SI5351_ERR_FAIL                 ESP_FAIL
+#define SI5351_ERR_TIMEOUT              ESP_ERR_TIMEOUT
+#define SI5351_ERR_INVALID_STATE        ESP_ERR_INVALID_STATE
+#define SI5351_ERR_NOT_INITIALISED      ESP_ERR_INVALID_STATE
+#define SI5351_ERR_INVALID_ARG          ESP_ERR_INVALID_ARG
+
+#else
+typedef int si5351_err_t;
+
+#define SI5351_OK                       0
+#define SI5351_ERR_FAIL                 (-1)
+#define SI5351_ERR_TIMEOUT              (-2)
+#define SI5351_ERR_INVALID_STATE        (-3)
+#define SI5351_ERR_NOT_INITIALISED      (-4)
+#define SI5351_ERR_INVALID_ARG          (-5)
+#endif
+
 
 typedef enum {
     SI5351_MS_CLK0,
@@ -106,21 +169,47 @@ typedef enum {
 } si5351_clk_r_div_t;
 
 
+// One register burst of si5351_bus_t.write_bursts().
+typedef struct {
+    uint8_t reg;
+    uint8_t count;
+    uint8_t* data;
+} si5351_burst_t;
+
+// I2C bus backend. read() writes the register address and reads count bytes
+// back (write-then-read), write() sends the register address followed by data.
+// write_bursts() is optional: a backend that can queue several register writes
+// into one bus operation uses it to send a whole transaction commit at once.
+// get_time_usec() is optional, a free running microsecond counter for timed sequences.
+typedef struct {
+    si5351_err_t (*read)(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count);
+    si5351_err_t (*write)(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count);
+    si5351_err_t (*write_bursts)(void* ctx, uint8_t i2c_addr, si5351_burst_t* bursts, uint8_t count);
+    void (*delay_msec)(void* ctx, uint32_t msec);
+    uint32_t (*get_time_usec)(void* ctx);
+    void* ctx;
+} si5351_bus_t;
+
 typedef struct {
     bool configured;
     si5351_pll_source_t source;
     uint32_t frequency;
+    int32_t error;                  // mHz, achieved minus frequency
 } si5351_pll_t;
 
 typedef struct {
     bool configured;
+    si5351_pll_reg_t pll;
+    si5351_clk_r_div_t r_div;
     uint32_t frequency;
+    int32_t error;                  // mHz, achieved minus frequency
 } si5351_ms_t;
 
 typedef enum si5351_variant si5351_variant_t;
 
 typedef struct {
     bool initialised;
+    const si5351_bus_t* bus;
     si5351_variant_t variant;
     si5351_revision_t rev_id;
     uint8_t i2c_address;
@@ -131,74 +220,96 @@ typedef struct {
     si5351_pll_t pll[SI5351_PLL_COUNT];
     si5351_ms_t ms[SI5351_MS_CLK_COUNT];
     uint8_t fanout_bm;
+    uint16_t lock_histogram[SI5351_PLL_COUNT][SI5351_LOCK_HISTOGRAM_BINS];
+    uint16_t lock_timeouts[SI5351_PLL_COUNT];
+    uint8_t regs[SI5351_REGISTER_COUNT];
+    uint8_t regs_valid[(SI5351_REGISTER_COUNT + 7) / 8];
+    uint8_t regs_dirty[(SI5351_REGISTER_COUNT + 7) / 8];
+    uint8_t transaction;
 } si5351_t;
 
 
 
 #if ARDUINO >= 100
-#include <Arduino.h>
-#include "i2c_master.h"
-
-typedef uint8_t si5351_err_t;
-
-#define SI5351_OK                       0x00
-#define SI5351_ERR_TIMEOUT              0x11
-#define SI5351_ERR_INVALID_STATE        0x12
-#define SI5351_ERR_NOT_INITIALISED      0x13
-#define SI5351_ERR_INVALID_ARG          0x14
-
-
-#define si5351_delay_msec(x)        do {            \
-        delay(x);                                   \
-    } while(0)
-
-inline si5351_err_t si5351_i2c_read(uint8_t i2c_addr, uint8_t reg, uint8_t *data, uint8_t count)
-{
-    i2c_addr &= 0x7F;
-    return (si5351_err_t)i2c_master_read_reg(i2c_addr, reg, data, count);
-}
-
-inline si5351_err_t si5351_i2c_write(uint8_t i2c_addr, uint8_t reg, uint8_t *data, uint8_t count)
-{
-    i2c_addr &= 0x7F;
-    return (si5351_err_t)i2c_master_write_reg(i2c_addr, reg, data, count);
-}
-
+extern const si5351_bus_t si5351_bus_arduino;
 #elif defined(ESP_PLATFORM)
-#include "i2c_master.h"
-#include "esp_err.h"
-
-typedef esp_err_t si5351_err_t;
-
-#define SI5351_OK                       ESP_OK
-#define SI5351_ERR_TIMEOUT              ESP_ERR_TIMEOUT
-#define SI5351_ERR_INVALID_STATE        ESP_ERR_INVALID_STATE
-#define SI5351_ERR_NOT_INITIALISED      ESP_ERR_INVALID_STATE
-#define SI5351_ERR_INVALID_ARG          ESP_ERR_INVALID_ARG
-
-
-#define si5351_delay_msec(x)        do {            \
-        vTaskDelay((x) / portTICK_PERIOD_MS);       \
-    } while(0)
-
-inline si5351_err_t si5351_i2c_read(uint8_t i2c_addr, uint8_t reg, uint8_t *data, uint8_t count)
-{
-    i2c_addr &= 0x7F;
-    return (si5351_err_t)i2c_master_read_reg(i2c_addr, reg, data, count);
-}
-
-inline si5351_err_t si5351_i2c_write(uint8_t i2c_addr, uint8_t reg, uint8_t *data, uint8_t count)
-{
-    i2c_addr &= 0x7F;
-    return (si5351_err_t)i2c_master_write_reg(i2c_addr, reg, data, count);
-}
-
-#else
-// Here you can put functions specific to your framework
+extern const si5351_bus_t si5351_bus_espidf;
 #endif
 
 
-si5351_err_t si5351_init(si5351_variant_t variant,
+// Handle-based API, one si5351_t per chip.
+si5351_err_t si5351_dev_init(si5351_t* dev, const si5351_bus_t* bus,
+                             si5351_variant_t variant,
+                             uint8_t i2c_address,
+                             si5351_crystal_freq_t xtal_frequency,
+                             uint32_t clkin_frequency,
+                             bool unbreakable);
+si5351_err_t si5351_dev_get_status(si5351_t* dev, uint8_t* status);
+si5351_err_t si5351_dev_set_crystal_load(si5351_t* dev, si5351_crystal_load_t cap);
+si5351_err_t si5351_dev_set_pll_source(si5351_t* dev, si5351_pll_source_t plla, si5351_pll_source_t pllb, si5351_clkin_divider_t divider);
+si5351_err_t si5351_dev_set_pll_vco(si5351_t* dev, si5351_pll_reg_t pll, uint32_t frequency);
+si5351_err_t si5351_dev_set_pll_vco_integer(si5351_t* dev, si5351_pll_reg_t pll, uint8_t a);
+si5351_err_t si5351_dev_set_pll_vco_fractional(si5351_t* dev, si5351_pll_reg_t pll, uint8_t a, uint32_t b, uint32_t c);
+si5351_err_t si5351_dev_set_pll_mode_integer(si5351_t* dev, si5351_pll_reg_t pll, bool integer);
+si5351_err_t si5351_dev_get_pll_frequency(si5351_t* dev, si5351_pll_reg_t pll, uint32_t* frequency);
+si5351_err_t si5351_dev_get_pll_error(si5351_t* dev, si5351_pll_reg_t pll, int32_t* error);
+si5351_err_t si5351_dev_reset_pll(si5351_t* dev);
+si5351_err_t si5351_dev_reset_single_pll(si5351_t* dev, si5351_pll_reg_t pll);
+// Polls LOL of the PLLs in pll_mask (bit 0 PLLA, bit 1 PLLB) until all are locked, lock_usec
+// is counted from the call. Every lock time goes into the histogram of its PLL, a timeout is counted.
+si5351_err_t si5351_dev_wait_lock(si5351_t* dev, uint8_t pll_mask, uint32_t timeout_usec, uint32_t* lock_usec);
+si5351_err_t si5351_dev_get_lock_histogram(si5351_t* dev, si5351_pll_reg_t pll, uint16_t* bins, uint16_t* timeouts);
+void si5351_dev_clear_lock_histogram(si5351_t* dev);
+si5351_err_t si5351_dev_set_multisynth(si5351_t* dev, si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint32_t frequency);
+si5351_err_t si5351_dev_set_multisynth_integer(si5351_t* dev, si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint16_t a);
+si5351_err_t si5351_dev_set_multisynth_fractional(si5351_t* dev, si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint16_t a, uint32_t b, uint32_t c);
+si5351_err_t si5351_dev_set_multisynth_mode_integer(si5351_t* dev, si5351_ms_clk_reg_t ms, bool integer);
+si5351_err_t si5351_dev_get_multisynth_frequency(si5351_t* dev, si5351_ms_clk_reg_t ms, uint32_t* frequency);
+si5351_err_t si5351_dev_get_multisynth_error(si5351_t* dev, si5351_ms_clk_reg_t ms, int32_t* error);
+// Output frequency in mHz, the multisynth and the R divider are chosen automatically.
+// The output keeps its PLL, PLLA when the multisynth was not configured yet.
+si5351_err_t si5351_dev_set_output_frequency(si5351_t* dev, si5351_ms_clk_reg_t clk, uint64_t frequency);
+si5351_err_t si5351_dev_get_output_frequency(si5351_t* dev, si5351_ms_clk_reg_t clk, uint64_t* frequency);
+// VFO: an even integer multisynth in integer mode, retuned through the PLL fraction only.
+// A new divider and R are chosen when the VCO would leave its range, the PLL is then reset and waited
+// for lock. Other outputs on the PLL move too.
+si5351_err_t si5351_dev_set_vfo_frequency(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_pll_reg_t pll, uint64_t frequency);
+// Ping-pong: the idle PLL is tuned, reset and waited for lock, then the output switches over by MS_SRC.
+// The idle PLL must not feed another output. A fractional multisynth or a VCO out of range gets a new even divider,
+// written before the switch: until MS_SRC flips, the old PLL drives the new divider.
+si5351_err_t si5351_dev_set_pingpong_frequency(si5351_t* dev, si5351_ms_clk_reg_t clk, uint64_t frequency);
+si5351_err_t si5351_dev_set_fanout(si5351_t* dev, bool clkin, bool xtal, bool ms);
+si5351_err_t si5351_dev_set_clk_disable_state(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_clk_state_t state);
+si5351_err_t si5351_dev_set_clk(si5351_t* dev, si5351_ms_clk_reg_t clk,
+                                bool powerup,
+                                bool inverted,
+                                si5351_clk_source_t clk_source,
+                                si5351_clk_r_div_t r,
+                                si5351_drv_strength_t drv_strength);
+si5351_err_t si5351_dev_set_clk_initial_phase(si5351_t* dev, si5351_ms_clk_reg_t clk, uint8_t phase);
+si5351_err_t si5351_dev_set_clk_inverted(si5351_t* dev, si5351_ms_clk_reg_t clk, bool inverted);
+si5351_err_t si5351_dev_set_clk_r_div(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_clk_r_div_t r);
+si5351_err_t si5351_dev_set_clk_strength(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_drv_strength_t drv_strength);
+si5351_err_t si5351_dev_set_clk_source(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_clk_source_t clk_source);
+si5351_err_t si5351_dev_set_clk_power_enable(si5351_t* dev, si5351_ms_clk_reg_t clk, bool enable);
+si5351_err_t si5351_dev_set_output_enable(si5351_t* dev, si5351_ms_clk_reg_t clk, bool enable);
+// Bulk variants, bit n of mask selects CLKn. controls holds CLK0_CONTROL..CLK7_CONTROL.
+si5351_err_t si5351_dev_set_output_enable_mask(si5351_t* dev, uint8_t mask, bool enable);
+si5351_err_t si5351_dev_set_clk_power_mask(si5351_t* dev, uint8_t mask, bool enable);
+si5351_err_t si5351_dev_set_clk_controls(si5351_t* dev, const uint8_t* controls);
+si5351_err_t si5351_dev_set_powerdown(si5351_t* dev);
+// Writes between si5351_begin() and si5351_commit() are held in the register shadow
+// and sent at commit as the fewest auto-increment bursts, in ascending register order.
+// Keep steps whose order matters (PLL reset, output enable) in a separate transaction.
+// si5351_abort() closes the transaction without writing: every write staged since the
+// outermost si5351_begin() is dropped and those registers are read from the chip again.
+si5351_err_t si5351_dev_begin(si5351_t* dev);
+si5351_err_t si5351_dev_commit(si5351_t* dev);
+si5351_err_t si5351_dev_abort(si5351_t* dev);
+
+// The same API on the built-in default instance.
+si5351_err_t si5351_init(const si5351_bus_t* bus,
+                         si5351_variant_t variant,
                          uint8_t i2c_address,
                          si5351_crystal_freq_t xtal_frequency,
                          uint32_t clkin_frequency,
@@ -211,12 +322,22 @@ si5351_err_t si5351_set_pll_vco_integer(si5351_pll_reg_t pll, uint8_t a);
 si5351_err_t si5351_set_pll_vco_fractional(si5351_pll_reg_t pll, uint8_t a, uint32_t b, uint32_t c);
 si5351_err_t si5351_set_pll_mode_integer(si5351_pll_reg_t pll, bool integer);
 si5351_err_t si5351_get_pll_frequency(si5351_pll_reg_t pll, uint32_t* frequency);
+si5351_err_t si5351_get_pll_error(si5351_pll_reg_t pll, int32_t* error);
 si5351_err_t si5351_reset_pll();
+si5351_err_t si5351_reset_single_pll(si5351_pll_reg_t pll);
+si5351_err_t si5351_wait_lock(uint8_t pll_mask, uint32_t timeout_usec, uint32_t* lock_usec);
+si5351_err_t si5351_get_lock_histogram(si5351_pll_reg_t pll, uint16_t* bins, uint16_t* timeouts);
+void si5351_clear_lock_histogram();
 si5351_err_t si5351_set_multisynth(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint32_t frequency);
 si5351_err_t si5351_set_multisynth_integer(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint16_t a);
 si5351_err_t si5351_set_multisynth_fractional(si5351_ms_clk_reg_t ms, si5351_pll_reg_t pll_source, uint16_t a, uint32_t b, uint32_t c);
 si5351_err_t si5351_set_multisynth_mode_integer(si5351_ms_clk_reg_t ms, bool integer);
 si5351_err_t si5351_get_multisynth_frequency(si5351_ms_clk_reg_t ms, uint32_t* frequency);
+si5351_err_t si5351_get_multisynth_error(si5351_ms_clk_reg_t ms, int32_t* error);
+si5351_err_t si5351_set_output_frequency(si5351_ms_clk_reg_t clk, uint64_t frequency);
+si5351_err_t si5351_get_output_frequency(si5351_ms_clk_reg_t clk, uint64_t* frequency);
+si5351_err_t si5351_set_vfo_frequency(si5351_ms_clk_reg_t clk, si5351_pll_reg_t pll, uint64_t frequency);
+si5351_err_t si5351_set_pingpong_frequency(si5351_ms_clk_reg_t clk, uint64_t frequency);
 si5351_err_t si5351_set_fanout(bool clkin, bool xtal, bool ms);
 si5351_err_t si5351_set_clk_disable_state(si5351_ms_clk_reg_t clk, si5351_clk_state_t state);
 si5351_err_t si5351_set_clk(si5351_ms_clk_reg_t clk,
@@ -232,7 +353,13 @@ si5351_err_t si5351_set_clk_strength(si5351_ms_clk_reg_t clk, si5351_drv_strengt
 si5351_err_t si5351_set_clk_source(si5351_ms_clk_reg_t clk, si5351_clk_source_t clk_source);
 si5351_err_t si5351_set_clk_power_enable(si5351_ms_clk_reg_t clk, bool enable);
 si5351_err_t si5351_set_output_enable(si5351_ms_clk_reg_t clk, bool enable);
+si5351_err_t si5351_set_output_enable_mask(uint8_t mask, bool enable);
+si5351_err_t si5351_set_clk_power_mask(uint8_t mask, bool enable);
+si5351_err_t si5351_set_clk_controls(const uint8_t* controls);
 si5351_err_t si5351_set_powerdown();
+si5351_err_t si5351_begin();
+si5351_err_t si5351_commit();
+si5351_err_t si5351_abort();
 
 
 
@@ -0,0 +1,183 @@
+/*
+ * si5351_config.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351_config.h"
+#include "si5351_private.h"
+#include <string.h>
+
+
+// function prototype
+si5351_err_t si5351_config_write(si5351_t* dev, const si5351_config_t* config, uint8_t* output_enable);
+uint8_t si5351_config_get_changed_plls(si5351_t* dev, const uint8_t* before, const bool* known);
+bool si5351_config_is_changed(si5351_t* dev, uint8_t index, uint8_t mask, const uint8_t* before, const bool* known);
+uint8_t si5351_config_get_clk_plls(si5351_t* dev, si5351_ms_clk_reg_t clk);
+
+
+#define SI5351_CONFIG_PLL_REGISTERS     4
+
+
+// registers shared by both PLLs or with the outputs, compared bit by bit
+const uint8_t si5351_config_pll_register[SI5351_CONFIG_PLL_REGISTERS] = {
+    SI5351_PLL_INPUT_SOURCE, SI5351_CLK6_CONTROL,
+    SI5351_CLK7_CONTROL, SI5351_CRYSTAL_INTERNAL_LOAD_CAP
+};
+
+
+si5351_err_t si5351_dev_apply(si5351_t* dev, const si5351_config_t* config)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if (config == NULL) goto finish;
+    if (!dev->initialised) {
+        result = SI5351_ERR_NOT_INITIALISED;
+        goto finish;
+    }
+    uint8_t before[SI5351_CONFIG_PLL_REGISTERS];
+    bool known[SI5351_CONFIG_PLL_REGISTERS];
+    for (uint8_t i = 0; i < SI5351_CONFIG_PLL_REGISTERS; i++) {
+        uint8_t reg = si5351_config_pll_register[i];
+        before[i] = dev->regs[reg];
+        known[i] = si5351_is_reg_cached(dev, reg) && !si5351_is_reg_dirty(dev, reg);
+    }
+    uint8_t current;
+    SI5351_GOTO_ON_ERROR(si5351_read_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, &current), finish);
+    uint8_t output_enable = 0xFF;
+    uint8_t output_off = current;
+    uint8_t reset = 0;
+    // the handle state the setters change, put back when the transaction is dropped
+    si5351_pll_t pll[SI5351_PLL_COUNT];
+    si5351_ms_t ms[SI5351_MS_CLK_COUNT];
+    memcpy(pll, dev->pll, sizeof(pll));
+    memcpy(ms, dev->ms, sizeof(ms));
+    si5351_crystal_load_t crystal_load = dev->crystal_load;
+    uint8_t clkin_divider = dev->clkin_divider;
+    uint8_t fanout_bm = dev->fanout_bm;
+    si5351_dev_begin(dev);
+    result = si5351_config_write(dev, config, &output_enable);
+    if (result == SI5351_OK) {
+        reset = si5351_config_get_changed_plls(dev, before, known);
+        // register 3 is the first one of the commit, the outputs go off before the rest is written
+        for (uint8_t i = SI5351_MS_CLK0; i < SI5351_MS_CLK_COUNT; i++) {
+            if ((output_enable & (1 << i)) || (si5351_config_get_clk_plls(dev, (si5351_ms_clk_reg_t)i) & reset)) output_off |= (1 << i);
+        }
+        result = si5351_write_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, output_off);
+    }
+    if (result == SI5351_OK) {
+        result = si5351_dev_commit(dev);
+    } else {
+        // nothing of a config that does not fit reaches the chip
+        si5351_dev_abort(dev);
+        memcpy(dev->pll, pll, sizeof(pll));
+        memcpy(dev->ms, ms, sizeof(ms));
+        dev->crystal_load = crystal_load;
+        dev->clkin_divider = clkin_divider;
+        dev->fanout_bm = fanout_bm;
+    }
+    if (result != SI5351_OK) goto finish;
+    if (reset == ((1 << SI5351_PLLA) | (1 << SI5351_PLLB))) {
+        SI5351_GOTO_ON_ERROR(si5351_dev_reset_pll(dev), finish);
+    } else if (reset != 0) {
+        SI5351_GOTO_ON_ERROR(si5351_dev_reset_single_pll(dev, (reset & (1 << SI5351_PLLA)) ? SI5351_PLLA : SI5351_PLLB), finish);
+    }
+    // only the PLLs of outputs about to be enabled are waited for
+    uint8_t pll_mask = 0;
+    for (uint8_t i = SI5351_MS_CLK0; i < SI5351_MS_CLK_COUNT; i++) {
+        if (!(output_enable & (1 << i))) pll_mask |= si5351_config_get_clk_plls(dev, (si5351_ms_clk_reg_t)i) & reset;
+    }
+    if (pll_mask != 0) SI5351_GOTO_ON_ERROR(si5351_dev_wait_lock(dev, pll_mask, SI5351_PLL_LOCK_TIME_ms * 1000UL, NULL), finish);
+    if (output_enable != output_off) SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, output_enable), finish);
+finish:
+    return result;
+}
+
+// everything but the output enable into the open transaction, output_enable gets register 3 of the config
+si5351_err_t si5351_config_write(si5351_t* dev, const si5351_config_t* config, uint8_t* output_enable)
+{
+    si5351_err_t result;
+    uint8_t reset = 0;
+    if (config->crystal_load != 0) SI5351_GOTO_ON_ERROR(si5351_dev_set_crystal_load(dev, config->crystal_load), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_pll_source(dev, config->pll_source[SI5351_PLLA], config->pll_source[SI5351_PLLB], config->clkin_divider), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_fanout(dev, config->fanout_clkin, config->fanout_xtal, config->fanout_ms), finish);
+    SI5351_GOTO_ON_ERROR(si5351_plan_write(dev, &(config->plan), &reset), finish);
+    *output_enable = 0xFF;
+    for (uint8_t i = SI5351_MS_CLK0; i < SI5351_MS_CLK_COUNT; i++) {
+        si5351_ms_clk_reg_t clk = (si5351_ms_clk_reg_t)i;
+        const si5351_config_clk_t* out = &(config->clk[i]);
+        if (out->powerup) {
+            SI5351_GOTO_ON_ERROR(si5351_dev_set_clk(dev, clk, true, out->inverted, out->source, config->plan.clk[i].r_div, out->drive), finish);
+            SI5351_GOTO_ON_ERROR(si5351_dev_set_clk_disable_state(dev, clk, out->disable_state), finish);
+            if (clk <= SI5351_MS_CLK5) SI5351_GOTO_ON_ERROR(si5351_dev_set_clk_initial_phase(dev, clk, out->phase), finish);
+            if (out->enabled) *output_enable &= ~(1 << i);
+        } else {
+            SI5351_GOTO_ON_ERROR(si5351_dev_set_clk_power_enable(dev, clk, false), finish);
+        }
+    }
+finish:
+    return result;
+}
+
+// PLLs (bit 0 PLLA, bit 1 PLLB) whose registers the open transaction changes,
+// before holds si5351_config_pll_register at begin, known when it was shadowed
+uint8_t si5351_config_get_changed_plls(si5351_t* dev, const uint8_t* before, const bool* known)
+{
+    uint8_t result = 0;
+    for (uint8_t p = SI5351_PLLA; p < SI5351_PLL_COUNT; p++) {
+        if (!dev->pll[p].configured) continue;
+        bool changed = false;
+        uint8_t reg = SI5351_MULTISYNTH_NA_PARAMETERS + p * SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH;
+        for (uint8_t i = 0; i < SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH; i++) {
+            if (si5351_is_reg_dirty(dev, reg + i)) changed = true;
+        }
+        uint8_t source = (p == SI5351_PLLA) ? SI5351_PLL_INPUT_SOURCE_PLLA_SRC_bm : SI5351_PLL_INPUT_SOURCE_PLLB_SRC_bm;
+        if (dev->pll[p].source == SI5351_PLL_CLKINT) source |= SI5351_PLL_INPUT_SOURCE_CLKIN_DIV_bm;
+        if (si5351_config_is_changed(dev, 0, source, before, known)) changed = true;
+        if (si5351_config_is_changed(dev, 1 + p, SI5351_CLK_CONTROL_FB_INT_bm, before, known)) changed = true;
+        if ((dev->pll[p].source == SI5351_PLL_XTAL) && si5351_config_is_changed(dev, 3, SI5351_CRYSTAL_INTERNAL_LOAD_CAP_XTAL_CL_bm, before, known)) changed = true;
+        // a new initial phase offset takes effect only at the reset of the PLL feeding the multisynth
+        for (uint8_t i = SI5351_MS_CLK0; i <= SI5351_MS_CLK5; i++) {
+            if (dev->ms[i].configured && (dev->ms[i].pll == p) && si5351_is_reg_dirty(dev, SI5351_CLK0_INITIAL_PHASE_OFFSET + i)) changed = true;
+        }
+        if (changed) result |= (1 << p);
+    }
+    return result;
+}
+
+bool si5351_config_is_changed(si5351_t* dev, uint8_t index, uint8_t mask, const uint8_t* before, const bool* known)
+{
+    uint8_t reg = si5351_config_pll_register[index];
+    if (!si5351_is_reg_dirty(dev, reg)) return false;
+    if (!known[index]) return true;
+    return ((before[index] ^ dev->regs[reg]) & mask) != 0;
+}
+
+// the PLL behind the output as a pll_mask bit, 0 for the crystal and CLKIN
+uint8_t si5351_config_get_clk_plls(si5351_t* dev, si5351_ms_clk_reg_t clk)
+{
+    uint8_t result = 0;
+    uint8_t control;
+    if (si5351_read_reg(dev, SI5351_CLK0_CONTROL + (uint8_t)clk, &control) != SI5351_OK) return 0;
+    uint8_t ms = clk;
+    switch (control & SI5351_CLK_CONTROL_CLK_SRC_bm) {
+        case SI5351_CLK_SOURCE_MS_0_OR_4:
+            ms = (clk < SI5351_MS_CLK4) ? SI5351_MS_CLK0 : SI5351_MS_CLK4;
+            // fall through
+        case SI5351_CLK_SOURCE_MS_X:
+            if (dev->ms[ms].configured) result = (1 << dev->ms[ms].pll);
+            break;
+        default:
+            break;
+    }
+    return result;
+}
+
+si5351_err_t si5351_apply(const si5351_config_t* config)
+{
+    return si5351_dev_apply(&chip, config);
+}
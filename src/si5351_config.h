@@ -0,0 +1,69 @@
+/*
+ * si5351_config.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_CONFIG_H_
+#define _SI5351_CONFIG_H_
+
+
+#include "si5351.h"
+#include "si5351_plan.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct {
+    bool powerup;                   // false powers the driver down, the other fields are left as they are
+    bool enabled;
+    bool inverted;
+    si5351_clk_source_t source;
+    si5351_drv_strength_t drive;
+    si5351_clk_state_t disable_state;
+    uint8_t phase;                  // CLK0..CLK5 only
+} si5351_config_clk_t;
+
+// The desired state of the whole chip. The PLL and multisynth dividers are a
+// si5351_plan_t (from si5351_plan() or filled in by hand), PLLs with frequency 0
+// and multisynths not used are left as they are. plan.clk[n].r_div is the R
+// divider of CLKn also when it is fed from MS0 or MS4. crystal_load 0 keeps
+// the crystal load.
+typedef struct {
+    si5351_crystal_load_t crystal_load;
+    si5351_pll_source_t pll_source[SI5351_PLL_COUNT];
+    si5351_clkin_divider_t clkin_divider;
+    bool fanout_clkin;
+    bool fanout_xtal;
+    bool fanout_ms;
+    si5351_plan_t plan;
+    si5351_config_clk_t clk[SI5351_MS_CLK_COUNT];
+} si5351_config_t;
+
+
+// Writes only the registers that differ from the register shadow, in one
+// transaction. Outputs that are turned off or run from a PLL with changed
+// registers or a changed initial phase offset are disabled first, only those
+// PLLs are reset and waited for, then the outputs are enabled. A config that
+// fails is dropped before anything is written, the chip and the handle keep
+// their state.
+si5351_err_t si5351_dev_apply(si5351_t* dev, const si5351_config_t* config);
+
+si5351_err_t si5351_apply(const si5351_config_t* config);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_CONFIG_H_
@@ -0,0 +1,180 @@
+/*
+ * si5351_constexpr.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_CONSTEXPR_H_
+#define _SI5351_CONSTEXPR_H_
+
+#ifndef __cplusplus
+#error "si5351_constexpr.h needs a C++11 compiler"
+#endif
+
+
+#include "si5351.h"
+#include "si5351_table.h"
+
+
+// Register bursts for frequencies fixed at build time. The divider search and
+// the P1/P2/P3 encoding follow si5351_get_best_fraction() and
+// si5351_set_parameters(), out of range requests stop the build. The result is
+// a constexpr si5351_table_entry_t for si5351_apply_table_entry():
+//
+//     typedef si5351_pll_entry<SI5351_PLLA, 25000000, 700000000> pll;
+//     typedef si5351_multisynth_entry<SI5351_MS_CLK0, pll, 10000000> clk0;
+//     si5351_apply_table_entry(&pll::entry);
+//     si5351_apply_table_entry(&clk0::entry);
+//
+// C++11 constexpr functions are single return statements, hence the recursion.
+
+struct si5351_fraction_t {
+    uint32_t b;
+    uint32_t c;
+};
+
+constexpr uint64_t si5351_constexpr_distance(uint64_t x, uint64_t y)
+{
+    return (x > y) ? x - y : y - x;
+}
+
+constexpr si5351_fraction_t si5351_constexpr_closer(uint64_t num, uint64_t den, uint64_t p1, uint64_t q1, uint64_t ps, uint64_t qs)
+{
+    return (si5351_constexpr_distance(num * qs, ps * den) * q1 < si5351_constexpr_distance(num * q1, p1 * den) * qs)
+            ? si5351_fraction_t{ (uint32_t)ps, (uint32_t)qs } : si5351_fraction_t{ (uint32_t)p1, (uint32_t)q1 };
+}
+
+constexpr si5351_fraction_t si5351_constexpr_best_fraction(uint64_t num, uint64_t den, uint64_t c_max,
+                                                           uint64_t n, uint64_t d, uint64_t p0, uint64_t q0, uint64_t p1, uint64_t q1)
+{
+    return (d == 0) ? si5351_fraction_t{ (uint32_t)p1, (uint32_t)q1 }
+            : ((q0 + n / d * q1) > c_max)
+            ? si5351_constexpr_closer(num, den, p1, q1, p0 + (c_max - q0) / q1 * p1, q0 + (c_max - q0) / q1 * q1)
+            : si5351_constexpr_best_fraction(num, den, c_max, d, n % d, p1, q1, p0 + n / d * p1, q0 + n / d * q1);
+}
+
+constexpr si5351_fraction_t si5351_constexpr_best_fraction(uint64_t num, uint64_t den)
+{
+    return si5351_constexpr_best_fraction(num, den, SI5351_MULTISYNTH_P3_bm, num, den, 0, 1, 1, 0);
+}
+
+constexpr uint32_t si5351_constexpr_p1(uint32_t a, uint32_t b, uint32_t c)
+{
+    return (uint32_t)128 * a + ((128 * b) / c) - 512;
+}
+
+constexpr uint32_t si5351_constexpr_p2(uint32_t b, uint32_t c)
+{
+    return 128 * b - c * ((128 * b) / c);
+}
+
+// byte i of the 8 parameter registers, as written by si5351_set_parameters()
+constexpr uint8_t si5351_constexpr_parameter(uint8_t i, uint32_t a, uint32_t b, uint32_t c)
+{
+    return (uint8_t)((i == 0) ? ((c >> 8) & 0xFF)
+            : (i == 1) ? (c & 0xFF)
+            : (i == 2) ? ((si5351_constexpr_p1(a, b, c) >> 16) & 0x03)
+            : (i == 3) ? ((si5351_constexpr_p1(a, b, c) >> 8) & 0xFF)
+            : (i == 4) ? (si5351_constexpr_p1(a, b, c) & 0xFF)
+            : (i == 5) ? (((c >> 12) & 0xF0) | ((si5351_constexpr_p2(b, c) >> 16) & 0x0F))
+            : (i == 6) ? ((si5351_constexpr_p2(b, c) >> 8) & 0xFF)
+            : (si5351_constexpr_p2(b, c) & 0xFF));
+}
+
+
+// Reference is the PLL input after the CLKIN divider, Vco the wanted VCO, both in Hz.
+template <si5351_pll_reg_t Pll, uint32_t Reference, uint32_t Vco>
+struct si5351_pll_entry {
+    static_assert((Pll == SI5351_PLLA) || (Pll == SI5351_PLLB), "no such PLL");
+    static_assert((Reference >= SI5351_PLL_CLKIN_MIN) && (Reference <= SI5351_PLL_CLKIN_MAX), "PLL reference out of range");
+#if (SI5351_ALLOW_OVERCLOCKING == 0)
+    static_assert((Vco >= SI5351_PLL_VCO_MIN) && (Vco <= SI5351_PLL_VCO_MAX), "VCO frequency out of range");
+#endif
+    static constexpr si5351_fraction_t fraction = si5351_constexpr_best_fraction(Vco % Reference, Reference);
+    // b == c rounds up to the next integer
+    static constexpr bool carry = (fraction.b == fraction.c);
+    static constexpr uint32_t a = Vco / Reference + (carry ? 1 : 0);
+    static constexpr uint32_t b = carry ? 0 : fraction.b;
+    static constexpr uint32_t c = carry ? 1 : fraction.c;
+    static_assert((a >= SI5351_PLL_INT_MIN) && (a <= SI5351_PLL_INT_MAX), "PLL multiplier out of range");
+    static constexpr uint32_t frequency = (uint32_t)(((uint64_t)Reference * b + c / 2) / c + (uint64_t)Reference * a);
+    static constexpr int32_t error = (int32_t)((((int64_t)Reference * a - frequency) * 1000) + ((uint64_t)Reference * 1000 * b + c / 2) / c);
+    static constexpr si5351_table_entry_t entry = {
+        SI5351_TABLE_PLL,
+        (uint8_t)Pll,
+        (uint8_t)((Pll == SI5351_PLLA) ? SI5351_MULTISYNTH_NA_PARAMETERS : SI5351_MULTISYNTH_NB_PARAMETERS),
+        SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH,
+        {
+            si5351_constexpr_parameter(0, a, b, c), si5351_constexpr_parameter(1, a, b, c),
+            si5351_constexpr_parameter(2, a, b, c), si5351_constexpr_parameter(3, a, b, c),
+            si5351_constexpr_parameter(4, a, b, c), si5351_constexpr_parameter(5, a, b, c),
+            si5351_constexpr_parameter(6, a, b, c), si5351_constexpr_parameter(7, a, b, c)
+        },
+        frequency,
+        error
+    };
+};
+
+template <si5351_pll_reg_t Pll, uint32_t Reference, uint32_t Vco>
+constexpr si5351_table_entry_t si5351_pll_entry<Pll, Reference, Vco>::entry;
+
+// Pll is the si5351_pll_entry feeding the output, Frequency the output in Hz
+// after the R divider. MS0..5 carry R in the burst; for CLK6 and CLK7 R is only
+// taken into account here and has to be set with si5351_set_clk_r_div().
+template <si5351_ms_clk_reg_t Clk, typename Pll, uint32_t Frequency, si5351_clk_r_div_t R = SI5351_CLK_R_DIVIDER_1>
+struct si5351_multisynth_entry {
+    static_assert((Clk >= SI5351_MS_CLK0) && (Clk < SI5351_MS_CLK_COUNT), "no such output");
+    static_assert(Frequency > 0, "output frequency out of range");
+    static constexpr bool integer_only = (Clk == SI5351_MS_CLK6) || (Clk == SI5351_MS_CLK7);
+    // millihertz, the VCO as achieved by the PLL entry
+    static constexpr uint64_t vco = (uint64_t)Pll::frequency * 1000 + Pll::error;
+    static constexpr uint64_t ms_frequency = ((uint64_t)Frequency * 1000) << (R >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp);
+    static constexpr si5351_fraction_t fraction = integer_only ? si5351_fraction_t{ 0, 1 } : si5351_constexpr_best_fraction(vco % ms_frequency, ms_frequency);
+    static constexpr bool carry = (fraction.b == fraction.c);
+    // CLK6 and CLK7 take the nearest even integer
+    static constexpr uint32_t a = (uint32_t)(integer_only ? (vco + ms_frequency) / (2 * ms_frequency) * 2 : vco / ms_frequency + (carry ? 1 : 0));
+    static constexpr uint32_t b = carry ? 0 : fraction.b;
+    static constexpr uint32_t c = carry ? 1 : fraction.c;
+#if (SI5351_ALLOW_OVERCLOCKING == 0)
+    static_assert(!integer_only || ((a >= SI5351_MULTISYNTH_INT_0_TO_7_MIN) && (a <= SI5351_MULTISYNTH_INT_0_TO_7_MAX)),
+            "CLK6/CLK7 divider out of range");
+#endif
+    // table entries run the multisynth in fractional mode, dividers 4 and 6 need si5351_set_multisynth_integer()
+    static_assert(integer_only || ((a >= SI5351_MULTISYNTH_FRAC_0_TO_5_MIN) && (a <= SI5351_MULTISYNTH_FRAC_0_TO_5_MAX)),
+            "multisynth divider out of range");
+    static_assert(integer_only || (a < SI5351_MULTISYNTH_FRAC_0_TO_5_MAX) || (b == 0), "multisynth divider out of range");
+    static constexpr uint64_t achieved = (vco * c + ((uint64_t)a * c + b) / 2) / ((uint64_t)a * c + b);
+    static constexpr uint32_t frequency = (uint32_t)((achieved + 500) / 1000);
+    static constexpr int32_t error = (int32_t)(achieved - (uint64_t)frequency * 1000);
+    static constexpr si5351_table_entry_t entry = {
+        SI5351_TABLE_MULTISYNTH,
+        (uint8_t)Clk,
+        (uint8_t)(integer_only ? SI5351_MULTISYNTH6_PARAMETERS + (Clk - SI5351_MS_CLK6)
+                : SI5351_MULTISYNTH0_PARAMETERS + Clk * SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH),
+        (uint8_t)(integer_only ? 1 : SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH),
+        {
+            integer_only ? (uint8_t)a : si5351_constexpr_parameter(0, a, b, c),
+            integer_only ? (uint8_t)0 : si5351_constexpr_parameter(1, a, b, c),
+            integer_only ? (uint8_t)0 : (uint8_t)(si5351_constexpr_parameter(2, a, b, c) | R),
+            integer_only ? (uint8_t)0 : si5351_constexpr_parameter(3, a, b, c),
+            integer_only ? (uint8_t)0 : si5351_constexpr_parameter(4, a, b, c),
+            integer_only ? (uint8_t)0 : si5351_constexpr_parameter(5, a, b, c),
+            integer_only ? (uint8_t)0 : si5351_constexpr_parameter(6, a, b, c),
+            integer_only ? (uint8_t)0 : si5351_constexpr_parameter(7, a, b, c)
+        },
+        frequency,
+        error
+    };
+};
+
+template <si5351_ms_clk_reg_t Clk, typename Pll, uint32_t Frequency, si5351_clk_r_div_t R>
+constexpr si5351_table_entry_t si5351_multisynth_entry<Clk, Pll, Frequency, R>::entry;
+
+
+
+#endif // _SI5351_CONSTEXPR_H_
@@ -34,6 +34,8 @@ enum si5351_variant {
 #define SI5351_I2C_ADDR_1                           0x61  // Si5351A 20-QFN, 24-QSOP, 16-QFN only
                                                     
 #define SI5351_POWERUP_TIME_ms                      (10)
+#define SI5351_PLL_LOCK_TIME_ms                     (10)
+#define SI5351_REGISTER_COUNT                       (188)
 #define SI5351_PLL_VCO_MIN                          (600000000UL)
 #define SI5351_PLL_VCO_MAX                          (900000000UL)
 #define SI5351_CLKIN_MIN                            (10000000UL)
@@ -134,6 +136,7 @@ enum {
 #define SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH  8
 enum {
     SI5351_MULTISYNTH0_PARAMETERS_MS_DIV4_bm        = 0x0C,
+    SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp      = 4,
     SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm      = 0x70,
     SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_1_bm    = 0x00,
     SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_2_bm    = 0x10,
@@ -147,6 +150,12 @@ enum {
 #define SI5351_MULTISYNTH6_PARAMETERS               90
 #define SI5351_MULTISYNTH7_PARAMETERS               91
 #define SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER         92
+enum {
+    SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R6_DIV_bm   = 0x07, // R6 Output Divider.
+    SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R6_DIV_bp   = 0,    // R6 Output Divider.
+    SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R7_DIV_bm   = 0x70, // R7 Output Divider.
+    SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R7_DIV_bp   = 4,    // R7 Output Divider.
+};
 
 #define SI5351_SPREAD_SPECTRUM_PARAMETERS           149
 
@@ -0,0 +1,97 @@
+/*
+ * si5351_event.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351_event.h"
+#include "si5351_private.h"
+#include <string.h>
+
+
+// function prototype
+void si5351_event_dispatch(si5351_events_t* events);
+
+
+si5351_err_t si5351_dev_event_init(si5351_t* dev, si5351_events_t* events, const si5351_event_handlers_t* handlers, uint8_t enabled)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((events == NULL) || (handlers == NULL) || ((enabled & ~SI5351_EVENT_ALL) != 0)) goto finish;
+    if (!dev->initialised) {
+        result = SI5351_ERR_NOT_INITIALISED;
+        goto finish;
+    }
+    // there is no CLKIN pin on the A and B variants, its LOS bit is always set
+    if (!si5351_is_variant_c(dev->variant)) enabled &= ~SI5351_EVENT_LOS_CLKIN;
+    memset(events, 0, sizeof(si5351_events_t));
+    events->handlers = handlers;
+    events->enabled = enabled;
+    // interrupt status sticky, interrupt status mask (a set bit masks the event)
+    uint8_t data[2] = { 0x00, (uint8_t)(SI5351_EVENT_ALL & ~enabled) };
+    result = si5351_write_regs(dev, SI5351_INTERRUPT_STATUS_STICKY, data, sizeof(data));
+finish:
+    return result;
+}
+
+void si5351_event_isr(si5351_events_t* events)
+{
+    events->interrupts++;
+    events->pending = true;
+}
+
+si5351_err_t si5351_dev_event_service(si5351_t* dev, si5351_events_t* events)
+{
+    si5351_err_t result = SI5351_OK;
+    if (!events->pending) goto finish;
+    events->pending = false;
+    // device status, interrupt status sticky
+    uint8_t data[2];
+    SI5351_GOTO_ON_ERROR(si5351_i2c_read(dev, SI5351_DEVICE_STATUS, data, sizeof(data)), finish);
+    // only the bits read are cleared, an event raised since then stays for the next INTR
+    SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, SI5351_INTERRUPT_STATUS_STICKY, (uint8_t)~data[1]), finish);
+    events->status = data[0];
+    events->sticky = data[1];
+    si5351_event_dispatch(events);
+finish:
+    return result;
+}
+
+void si5351_event_dispatch(si5351_events_t* events)
+{
+    const si5351_event_handlers_t* handlers = events->handlers;
+    uint8_t seen = events->sticky & events->enabled;
+    if ((seen & SI5351_EVENT_SYS_INIT) && (handlers->sys_init != NULL)) {
+        handlers->sys_init(handlers->ctx, (events->status & SI5351_EVENT_SYS_INIT) != 0);
+    }
+    if (handlers->loss_of_signal != NULL) {
+        if (seen & SI5351_EVENT_LOS_XTAL) {
+            handlers->loss_of_signal(handlers->ctx, SI5351_PLL_XTAL, (events->status & SI5351_EVENT_LOS_XTAL) != 0);
+        }
+        if (seen & SI5351_EVENT_LOS_CLKIN) {
+            handlers->loss_of_signal(handlers->ctx, SI5351_PLL_CLKINT, (events->status & SI5351_EVENT_LOS_CLKIN) != 0);
+        }
+    }
+    if (handlers->loss_of_lock != NULL) {
+        if (seen & SI5351_EVENT_LOL_A) {
+            handlers->loss_of_lock(handlers->ctx, SI5351_PLLA, (events->status & SI5351_EVENT_LOL_A) != 0);
+        }
+        if (seen & SI5351_EVENT_LOL_B) {
+            handlers->loss_of_lock(handlers->ctx, SI5351_PLLB, (events->status & SI5351_EVENT_LOL_B) != 0);
+        }
+    }
+}
+
+si5351_err_t si5351_event_init(si5351_events_t* events, const si5351_event_handlers_t* handlers, uint8_t enabled)
+{
+    return si5351_dev_event_init(&chip, events, handlers, enabled);
+}
+
+si5351_err_t si5351_event_service(si5351_events_t* events)
+{
+    return si5351_dev_event_service(&chip, events);
+}
@@ -0,0 +1,72 @@
+/*
+ * si5351_event.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_EVENT_H_
+#define _SI5351_EVENT_H_
+
+
+#include "si5351.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef enum {
+    SI5351_EVENT_LOS_XTAL       = SI5351_DEVICE_STATUS_LOS_XTAL_bm,
+    SI5351_EVENT_LOS_CLKIN      = SI5351_DEVICE_STATUS_LOS_CLKIN_bm,
+    SI5351_EVENT_LOL_A          = SI5351_DEVICE_STATUS_LOL_A_bm,
+    SI5351_EVENT_LOL_B          = SI5351_DEVICE_STATUS_LOL_B_bm,
+    SI5351_EVENT_SYS_INIT       = SI5351_DEVICE_STATUS_SYS_INIT_bm,
+    SI5351_EVENT_ALL            = 0xF8
+} si5351_event_t;
+
+// active is true when the condition is still present at the service, false
+// when only its sticky bit was left. Unused handlers may be NULL.
+typedef struct {
+    void (*loss_of_lock)(void* ctx, si5351_pll_reg_t pll, bool active);
+    void (*loss_of_signal)(void* ctx, si5351_pll_source_t source, bool active);
+    void (*sys_init)(void* ctx, bool active);
+    void* ctx;
+} si5351_event_handlers_t;
+
+// Events from the INTR pin. si5351_event_init() unmasks the selected events
+// (LOS_CLKIN only on the C variant) and clears the sticky bits, the pin ISR
+// calls si5351_event_isr(), which only takes a note and is safe in interrupt
+// context. si5351_event_service() is called from the main loop: when an
+// interrupt came it reads the status and the sticky bits in one burst,
+// clears the sticky bits and calls the handlers.
+typedef struct {
+    const si5351_event_handlers_t* handlers;
+    uint8_t enabled;
+    volatile bool pending;
+    volatile uint32_t interrupts;
+    uint8_t status;                 // device status at the last service
+    uint8_t sticky;                 // sticky bits at the last service
+} si5351_events_t;
+
+
+si5351_err_t si5351_dev_event_init(si5351_t* dev, si5351_events_t* events, const si5351_event_handlers_t* handlers, uint8_t enabled);
+si5351_err_t si5351_dev_event_service(si5351_t* dev, si5351_events_t* events);
+void si5351_event_isr(si5351_events_t* events);
+
+si5351_err_t si5351_event_init(si5351_events_t* events, const si5351_event_handlers_t* handlers, uint8_t enabled);
+si5351_err_t si5351_event_service(si5351_events_t* events);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_EVENT_H_
@@ -0,0 +1,181 @@
+/*
+ * si5351_fsk.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351_fsk.h"
+#include "si5351_private.h"
+#include <string.h>
+
+
+// function prototype
+si5351_err_t si5351_fsk_apply(si5351_t* dev, si5351_fsk_t* fsk);
+void si5351_fsk_wait(si5351_t* dev, uint32_t edge_usec);
+
+
+si5351_err_t si5351_dev_fsk_build_tones(si5351_t* dev, si5351_ms_clk_reg_t clk, uint64_t frequency, uint64_t spacing,
+                                       uint8_t count, si5351_table_entry_t* tones)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((tones == NULL) || (count == 0) || (frequency == 0) || (spacing == 0)) goto finish;
+    if ((clk < SI5351_MS_CLK0) || (clk >= SI5351_MS_CLK_COUNT)) goto finish;
+    if (!dev->initialised || !dev->ms[clk].configured) {
+        result = SI5351_ERR_NOT_INITIALISED;
+        goto finish;
+    }
+    si5351_pll_reg_t pll = dev->ms[clk].pll;
+    // PLLB of the B variant is the VCXO PLL, its fraction is fixed
+    if ((pll == SI5351_PLLB) && si5351_is_variant_b(dev->variant)) goto finish;
+    uint16_t divider;
+    SI5351_GOTO_ON_ERROR(si5351_get_integer_divider(dev, clk, &divider), finish);
+    result = SI5351_ERR_INVALID_ARG;
+    uint8_t r = dev->ms[clk].r_div >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp;
+    uint32_t in_frequency = si5351_get_pll_source_frequency(dev, pll);
+    uint64_t reference = (uint64_t)in_frequency * 1000;
+    uint64_t vco_freq = frequency * divider << r;
+    uint64_t vco_spacing = spacing * divider << r;
+    if ((in_frequency == 0) || (vco_spacing >= reference)) goto finish;
+    // spacing_b / c ~ vco_spacing / reference, c scaled up as far as P3 allows
+    uint32_t spacing_b, c;
+    si5351_get_best_fraction(vco_spacing, reference, SI5351_MULTISYNTH_P3_bm, &spacing_b, &c);
+    if (spacing_b == 0) goto finish;
+    uint32_t scale = SI5351_MULTISYNTH_P3_bm / c;
+    spacing_b *= scale;
+    c *= scale;
+    uint64_t a = vco_freq / reference;
+    uint64_t b = SI5351_DIVIDE_ROUND((vco_freq % reference) * c, reference);
+    for (uint8_t i = 0; i < count; i++) {
+        SI5351_GOTO_ON_ERROR(si5351_table_set_pll_entry(pll, in_frequency, a + b / c, (uint32_t)(b % c), c, &(tones[i])), finish);
+        b += spacing_b;
+    }
+finish:
+    return result;
+}
+
+si5351_err_t si5351_fsk_init(si5351_fsk_t* fsk, const si5351_table_entry_t* tones, uint8_t tone_count,
+                             const uint8_t* symbols, uint16_t symbol_count, uint64_t symbol_nsec)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((fsk == NULL) || (tones == NULL) || (tone_count == 0) || (symbols == NULL) || (symbol_count == 0) || (symbol_nsec == 0)) goto finish;
+    // every tone rewrites the same registers
+    for (uint8_t i = 1; i < tone_count; i++) {
+        if ((tones[i].mode != tones[0].mode) || (tones[i].index != tones[0].index)) goto finish;
+        if ((tones[i].reg != tones[0].reg) || (tones[i].count != tones[0].count)) goto finish;
+    }
+    for (uint16_t i = 0; i < symbol_count; i++) {
+        if (symbols[i] >= tone_count) goto finish;
+    }
+    memset(fsk, 0, sizeof(si5351_fsk_t));
+    fsk->tones = tones;
+    fsk->tone_count = tone_count;
+    fsk->symbols = symbols;
+    fsk->symbol_count = symbol_count;
+    fsk->symbol_nsec = symbol_nsec;
+    result = SI5351_OK;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_dev_fsk_start(si5351_t* dev, si5351_fsk_t* fsk)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_STATE;
+    if ((dev->bus == NULL) || (dev->bus->get_time_usec == NULL) || (fsk->tones == NULL)) goto finish;
+    fsk->position = 0;
+    fsk->edges = 0;
+    fsk->latency_min_usec = INT32_MAX;
+    fsk->latency_max_usec = INT32_MIN;
+    fsk->latency_sum_usec = 0;
+    fsk->start_usec = dev->bus->get_time_usec(dev->bus->ctx);
+    fsk->edge_usec = fsk->start_usec;
+    // the first tone goes out whole, it also clears the integer mode bits
+    const si5351_table_entry_t* tone = &(fsk->tones[fsk->symbols[0]]);
+    SI5351_GOTO_ON_ERROR(si5351_dev_apply_table_entry(dev, tone), finish);
+    memcpy(fsk->data, tone->data, tone->count);
+    SI5351_GOTO_ON_ERROR(si5351_fsk_apply(dev, fsk), finish);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_dev_fsk_tick(si5351_t* dev, si5351_fsk_t* fsk)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_STATE;
+    if ((fsk->position == 0) || (fsk->position >= fsk->symbol_count)) goto finish;
+    result = si5351_fsk_apply(dev, fsk);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_dev_fsk_run(si5351_t* dev, si5351_fsk_t* fsk)
+{
+    si5351_err_t result;
+    SI5351_GOTO_ON_ERROR(si5351_dev_fsk_start(dev, fsk), finish);
+    while (fsk->position < fsk->symbol_count) {
+        si5351_fsk_wait(dev, fsk->edge_usec);
+        SI5351_GOTO_ON_ERROR(si5351_dev_fsk_tick(dev, fsk), finish);
+    }
+    // the last symbol lasts its full period too
+    si5351_fsk_wait(dev, fsk->edge_usec);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_fsk_apply(si5351_t* dev, si5351_fsk_t* fsk)
+{
+    si5351_err_t result = SI5351_OK;
+    const si5351_table_entry_t* tone = &(fsk->tones[fsk->symbols[fsk->position]]);
+    // only the registers between the first and the last changed byte
+    uint8_t first = 0;
+    uint8_t last = tone->count;
+    while ((first < last) && (tone->data[first] == fsk->data[first])) first++;
+    while ((last > first) && (tone->data[last - 1] == fsk->data[last - 1])) last--;
+    if (first < last) {
+        SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, tone->reg + first, (uint8_t*)&(tone->data[first]), last - first), finish);
+        memcpy(&(fsk->data[first]), &(tone->data[first]), last - first);
+    }
+    si5351_table_set_state(dev, tone);
+    int32_t latency = (int32_t)(dev->bus->get_time_usec(dev->bus->ctx) - fsk->edge_usec);
+    if (latency < fsk->latency_min_usec) fsk->latency_min_usec = latency;
+    if (latency > fsk->latency_max_usec) fsk->latency_max_usec = latency;
+    fsk->latency_sum_usec += latency;
+    fsk->edges++;
+    fsk->position++;
+    // edges from the start, the period error does not add up
+    fsk->edge_usec = fsk->start_usec + (uint32_t)(fsk->symbol_nsec * fsk->position / 1000);
+finish:
+    return result;
+}
+
+void si5351_fsk_wait(si5351_t* dev, uint32_t edge_usec)
+{
+    // sleep while more than a millisecond is left, then poll the timer
+    int32_t left = (int32_t)(edge_usec - dev->bus->get_time_usec(dev->bus->ctx));
+    if (left > 1000) dev->bus->delay_msec(dev->bus->ctx, (uint32_t)left / 1000 - 1);
+    while ((int32_t)(edge_usec - dev->bus->get_time_usec(dev->bus->ctx)) > 0);
+}
+
+si5351_err_t si5351_fsk_build_tones(si5351_ms_clk_reg_t clk, uint64_t frequency, uint64_t spacing,
+                                   uint8_t count, si5351_table_entry_t* tones)
+{
+    return si5351_dev_fsk_build_tones(&chip, clk, frequency, spacing, count, tones);
+}
+
+si5351_err_t si5351_fsk_start(si5351_fsk_t* fsk)
+{
+    return si5351_dev_fsk_start(&chip, fsk);
+}
+
+si5351_err_t si5351_fsk_tick(si5351_fsk_t* fsk)
+{
+    return si5351_dev_fsk_tick(&chip, fsk);
+}
+
+si5351_err_t si5351_fsk_run(si5351_fsk_t* fsk)
+{
+    return si5351_dev_fsk_run(&chip, fsk);
+}
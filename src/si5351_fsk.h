@@ -0,0 +1,71 @@
+/*
+ * si5351_fsk.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_FSK_H_
+#define _SI5351_FSK_H_
+
+
+#include "si5351.h"
+#include "si5351_table.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Symbol sequencer for WSPR, FT8 and JT modes. The tones are table entries of
+// one output or PLL, an edge writes only the bytes that differ from the tone
+// before. si5351_fsk_build_tones() puts evenly spaced tones on the PLL of an
+// integer output with one denominator, so a tone change is a P1/P2 delta.
+// si5351_fsk_tick() is called from a timer at edge_usec, or si5351_fsk_run()
+// waits for the edges itself. Both need bus get_time_usec().
+typedef struct {
+    const si5351_table_entry_t* tones;
+    uint8_t tone_count;
+    const uint8_t* symbols;
+    uint16_t symbol_count;
+    uint64_t symbol_nsec;
+    uint16_t position;              // the next symbol
+    uint32_t start_usec;
+    uint32_t edge_usec;             // the next symbol edge
+    uint8_t data[SI5351_TABLE_DATA_LENGTH];
+    // from the scheduled edge to the end of its write, jitter is max - min
+    uint16_t edges;
+    int32_t latency_min_usec;
+    int32_t latency_max_usec;
+    int32_t latency_sum_usec;
+} si5351_fsk_t;
+
+
+// frequency and spacing in mHz
+si5351_err_t si5351_dev_fsk_build_tones(si5351_t* dev, si5351_ms_clk_reg_t clk, uint64_t frequency, uint64_t spacing,
+                                       uint8_t count, si5351_table_entry_t* tones);
+si5351_err_t si5351_fsk_init(si5351_fsk_t* fsk, const si5351_table_entry_t* tones, uint8_t tone_count,
+                             const uint8_t* symbols, uint16_t symbol_count, uint64_t symbol_nsec);
+si5351_err_t si5351_dev_fsk_start(si5351_t* dev, si5351_fsk_t* fsk);
+si5351_err_t si5351_dev_fsk_tick(si5351_t* dev, si5351_fsk_t* fsk);
+si5351_err_t si5351_dev_fsk_run(si5351_t* dev, si5351_fsk_t* fsk);
+
+si5351_err_t si5351_fsk_build_tones(si5351_ms_clk_reg_t clk, uint64_t frequency, uint64_t spacing,
+                                   uint8_t count, si5351_table_entry_t* tones);
+si5351_err_t si5351_fsk_start(si5351_fsk_t* fsk);
+si5351_err_t si5351_fsk_tick(si5351_fsk_t* fsk);
+si5351_err_t si5351_fsk_run(si5351_fsk_t* fsk);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_FSK_H_
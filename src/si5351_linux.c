@@ -0,0 +1,120 @@
+/*
+ * si5351_linux.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351_linux.h"
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+
+// function prototype
+si5351_err_t si5351_linux_read(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count);
+si5351_err_t si5351_linux_write(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count);
+si5351_err_t si5351_linux_write_bursts(void* ctx, uint8_t i2c_addr, si5351_burst_t* bursts, uint8_t count);
+void si5351_linux_delay_msec(void* ctx, uint32_t msec);
+uint32_t si5351_linux_get_time_usec(void* ctx);
+
+
+#define SI5351_LINUX_BUFFER_LENGTH      512
+
+
+si5351_err_t si5351_linux_open(si5351_bus_t* bus, si5351_linux_t* dev, const char* path)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((bus == NULL) || (dev == NULL) || (path == NULL)) goto finish;
+    dev->fd = open(path, O_RDWR);
+    if (dev->fd < 0) {
+        result = SI5351_ERR_FAIL;
+        goto finish;
+    }
+    bus->read = si5351_linux_read;
+    bus->write = si5351_linux_write;
+    bus->write_bursts = si5351_linux_write_bursts;
+    bus->delay_msec = si5351_linux_delay_msec;
+    bus->get_time_usec = si5351_linux_get_time_usec;
+    bus->ctx = dev;
+    result = SI5351_OK;
+finish:
+    return result;
+}
+
+void si5351_linux_close(si5351_linux_t* dev)
+{
+    if ((dev != NULL) && (dev->fd >= 0)) {
+        close(dev->fd);
+        dev->fd = -1;
+    }
+}
+
+si5351_err_t si5351_linux_read(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    si5351_linux_t* dev = (si5351_linux_t*)ctx;
+    struct i2c_msg msgs[2] = {
+        { .addr = i2c_addr, .flags = 0, .len = 1, .buf = &reg },
+        { .addr = i2c_addr, .flags = I2C_M_RD, .len = count, .buf = data },
+    };
+    struct i2c_rdwr_ioctl_data xfer = { .msgs = msgs, .nmsgs = 2 };
+    if (ioctl(dev->fd, I2C_RDWR, &xfer) < 0) return SI5351_ERR_FAIL;
+    return SI5351_OK;
+}
+
+si5351_err_t si5351_linux_write(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    si5351_burst_t burst = { .reg = reg, .count = count, .data = data };
+    return si5351_linux_write_bursts(ctx, i2c_addr, &burst, 1);
+}
+
+si5351_err_t si5351_linux_write_bursts(void* ctx, uint8_t i2c_addr, si5351_burst_t* bursts, uint8_t count)
+{
+    si5351_linux_t* dev = (si5351_linux_t*)ctx;
+    struct i2c_msg msgs[I2C_RDWR_IOCTL_MAX_MSGS];
+    uint8_t buffer[SI5351_LINUX_BUFFER_LENGTH];
+    uint8_t i = 0;
+    while (i < count) {
+        // pack as many bursts as fit into one combined transfer, register address first
+        uint16_t length = 0;
+        uint8_t n = 0;
+        while ((i < count) && (n < I2C_RDWR_IOCTL_MAX_MSGS) && ((length + bursts[i].count + 1) <= SI5351_LINUX_BUFFER_LENGTH)) {
+            msgs[n].addr = i2c_addr;
+            msgs[n].flags = 0;
+            msgs[n].len = bursts[i].count + 1;
+            msgs[n].buf = &(buffer[length]);
+            buffer[length] = bursts[i].reg;
+            memcpy(&(buffer[length + 1]), bursts[i].data, bursts[i].count);
+            length += bursts[i].count + 1;
+            n++;
+            i++;
+        }
+        if (n == 0) return SI5351_ERR_INVALID_ARG;
+        struct i2c_rdwr_ioctl_data xfer = { .msgs = msgs, .nmsgs = n };
+        if (ioctl(dev->fd, I2C_RDWR, &xfer) < 0) return SI5351_ERR_FAIL;
+    }
+    return SI5351_OK;
+}
+
+void si5351_linux_delay_msec(void* ctx, uint32_t msec)
+{
+    (void)ctx;
+    struct timespec ts = { .tv_sec = msec / 1000, .tv_nsec = (long)(msec % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+uint32_t si5351_linux_get_time_usec(void* ctx)
+{
+    (void)ctx;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
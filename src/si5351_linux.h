@@ -0,0 +1,41 @@
+/*
+ * si5351_linux.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_LINUX_H_
+#define _SI5351_LINUX_H_
+
+
+#include "si5351.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Linux /dev/i2c-N backend. Every register access is a single I2C_RDWR ioctl,
+// write_bursts() packs a whole transaction commit into one ioctl.
+typedef struct {
+    int fd;
+} si5351_linux_t;
+
+
+si5351_err_t si5351_linux_open(si5351_bus_t* bus, si5351_linux_t* dev, const char* path);
+void si5351_linux_close(si5351_linux_t* dev);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_LINUX_H_
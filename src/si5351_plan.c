@@ -0,0 +1,332 @@
+/*
+ * si5351_plan.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351_plan.h"
+#include "si5351_private.h"
+#include <string.h>
+
+
+// function prototype
+uint32_t si5351_plan_get_lead_vco(si5351_ms_clk_reg_t clk, uint32_t ms_frequency, uint32_t reference, uint32_t vco_min, uint32_t vco_max,
+                                  const si5351_plan_target_t* targets, const uint32_t* ms_frequencies, const bool* assigned, uint8_t count);
+uint32_t si5351_plan_get_vco_cap(const si5351_plan_t* plan, uint32_t vco_max, const uint32_t* ms_frequencies,
+                                 const bool* assigned, const bool* hard, uint8_t count, uint8_t lead, uint8_t* capped);
+bool si5351_plan_get_even_divider(si5351_ms_clk_reg_t clk, uint32_t vco, uint32_t ms_frequency, uint16_t* a);
+bool si5351_plan_get_fractional_divider(uint32_t vco, uint32_t ms_frequency, uint16_t* a, uint32_t* b, uint32_t* c);
+uint8_t si5351_plan_get_output_count(si5351_variant_t variant);
+uint32_t si5351_plan_gcd(uint32_t x, uint32_t y);
+
+
+si5351_err_t si5351_dev_plan(si5351_t* dev, const si5351_plan_target_t* targets, uint8_t count,
+                             const si5351_plan_constraints_t* constraints, si5351_plan_t* plan)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    uint32_t ms_frequencies[SI5351_MS_CLK_COUNT];
+    uint8_t r_dividers[SI5351_MS_CLK_COUNT];
+    bool assigned[SI5351_MS_CLK_COUNT];
+    bool hard[SI5351_MS_CLK_COUNT];
+    if ((targets == NULL) || (plan == NULL) || (count > SI5351_MS_CLK_COUNT)) goto finish;
+    if (!dev->initialised) {
+        result = SI5351_ERR_NOT_INITIALISED;
+        goto finish;
+    }
+    memset(plan, 0, sizeof(si5351_plan_t));
+    uint32_t vco_min = SI5351_PLL_VCO_MIN;
+    uint32_t vco_max = SI5351_PLL_VCO_MAX;
+    uint8_t pll_mask = (1 << SI5351_PLLA) | (1 << SI5351_PLLB);
+    bool integer_only = false;
+    if (constraints != NULL) {
+        if (constraints->vco_min) vco_min = constraints->vco_min;
+        if (constraints->vco_max) vco_max = constraints->vco_max;
+        if (constraints->pll_mask) pll_mask = constraints->pll_mask;
+        integer_only = constraints->integer_only;
+    }
+    // PLLB of the VCXO variant runs with c = 10^6 and belongs to the VCXO
+    if (si5351_is_variant_b(dev->variant)) pll_mask &= ~(1 << SI5351_PLLB);
+    if ((vco_min > vco_max) || (pll_mask == 0)) goto finish;
+    uint32_t out_min = (dev->rev_id == SI5351_REVISION_A) ? SI5351_REVA_MULTISYNTH_FREQUENCY_MIN : SI5351_REVB_MULTISYNTH_FREQUENCY_MIN;
+    uint32_t ms_max = (dev->rev_id == SI5351_REVISION_A) ? SI5351_REVA_MULTISYNTH_FREQUENCY_MAX : SI5351_REVB_MULTISYNTH_FREQUENCY_MAX;
+    uint8_t outputs = si5351_plan_get_output_count(dev->variant);
+    uint8_t clk_mask = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        si5351_ms_clk_reg_t clk = targets[i].clk;
+        uint32_t frequency = targets[i].frequency;
+        if ((clk < SI5351_MS_CLK0) || (clk >= outputs) || (clk_mask & (1 << clk))) goto finish;
+        clk_mask |= (1 << clk);
+        if (frequency < out_min) goto finish;
+#if (SI5351_ALLOW_OVERCLOCKING == 0)
+        if (frequency > ms_max) goto finish;
+#endif
+        // the smallest R divider that keeps the multisynth divider in range at the highest VCO,
+        // or at least at the lowest one
+        uint16_t a_max = (clk >= SI5351_MS_CLK6) ? SI5351_MULTISYNTH_INT_0_TO_7_MAX : SI5351_MULTISYNTH_FRAC_0_TO_5_MAX;
+        uint8_t r = 0;
+        while ((r < 7) && ((uint64_t)(frequency << r) * a_max < vco_max)) r++;
+        if ((uint64_t)(frequency << r) * a_max < vco_min) goto finish;
+        ms_frequencies[i] = frequency << r;
+        r_dividers[i] = r;
+        assigned[i] = false;
+        hard[i] = integer_only || (clk >= SI5351_MS_CLK6) || ((uint64_t)ms_frequencies[i] * SI5351_MULTISYNTH_FRAC_0_TO_5_MIN > vco_max);
+    }
+    // integer-only outputs first, then the rest, each one:
+    // in even integer mode on a PLL already planned, or leading a free PLL, or fractional
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        for (uint8_t i = 0; i < count; i++) {
+            si5351_ms_clk_reg_t clk = targets[i].clk;
+            uint32_t ms_frequency = ms_frequencies[i];
+            if (assigned[i] || (hard[i] != (pass == 0))) continue;
+            si5351_plan_clk_t* out = &(plan->clk[clk]);
+            out->r_div = (si5351_clk_r_div_t)(r_dividers[i] << SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp);
+            out->b = 0;
+            out->c = 1;
+            for (uint8_t p = SI5351_PLLA; (p < SI5351_PLL_COUNT) && !assigned[i]; p++) {
+                if (plan->pll[p].frequency == 0) continue;
+                if (si5351_plan_get_even_divider(clk, plan->pll[p].frequency, ms_frequency, &(out->a))) {
+                    out->pll = (si5351_pll_reg_t)p;
+                    assigned[i] = true;
+                }
+            }
+            for (uint8_t p = SI5351_PLLA; (p < SI5351_PLL_COUNT) && !assigned[i]; p++) {
+                if (!(pll_mask & (1 << p)) || (plan->pll[p].frequency != 0)) continue;
+                uint32_t reference = si5351_get_pll_source_frequency(dev, (si5351_pll_reg_t)p);
+                if ((reference < SI5351_PLL_CLKIN_MIN) || (reference > SI5351_PLL_CLKIN_MAX)) continue;
+                // the last free PLL has to stay low enough for the fractional outputs no planned PLL can take
+                uint32_t vco_cap = vco_max;
+                uint8_t capped = i;
+                bool last = true;
+                for (uint8_t q = p + 1; q < SI5351_PLL_COUNT; q++) {
+                    if ((pll_mask & (1 << q)) && (plan->pll[q].frequency == 0)) last = false;
+                }
+                if (last) vco_cap = si5351_plan_get_vco_cap(plan, vco_max, ms_frequencies, assigned, hard, count, i, &capped);
+                uint32_t vco = si5351_plan_get_lead_vco(clk, ms_frequency, reference, vco_min, vco_cap, targets, ms_frequencies, assigned, count);
+                if ((vco == 0) && (capped != i) && !hard[i]) {
+                    // nothing even below the cap, the capped output leads the PLL and this one goes fractional below
+                    plan->pll[p].frequency = si5351_plan_get_lead_vco(targets[capped].clk, ms_frequencies[capped], reference, vco_min, vco_cap,
+                                                                     targets, ms_frequencies, assigned, count);
+                    continue;
+                }
+                if (vco == 0) continue;
+                plan->pll[p].frequency = vco;
+                si5351_plan_get_even_divider(clk, vco, ms_frequency, &(out->a));
+                out->pll = (si5351_pll_reg_t)p;
+                assigned[i] = true;
+            }
+            if (!assigned[i] && !hard[i]) {
+                int32_t best = INT32_MAX;
+                for (uint8_t p = SI5351_PLLA; p < SI5351_PLL_COUNT; p++) {
+                    uint16_t a;
+                    uint32_t b, c;
+                    if (plan->pll[p].frequency == 0) continue;
+                    if (!si5351_plan_get_fractional_divider(plan->pll[p].frequency, ms_frequency, &a, &b, &c)) continue;
+                    int32_t error = si5351_get_divider_error((uint64_t)plan->pll[p].frequency * 1000, (uint64_t)ms_frequency * 1000, a, b, c);
+                    if (((error < 0) ? -error : error) < best) {
+                        best = (error < 0) ? -error : error;
+                        out->pll = (si5351_pll_reg_t)p;
+                        out->a = a;
+                        out->b = b;
+                        out->c = c;
+                        out->error = error / (1 << r_dividers[i]);
+                        assigned[i] = true;
+                    }
+                }
+            }
+            if (!assigned[i]) goto finish;
+            out->used = true;
+        }
+    }
+    // feedback dividers for the chosen VCO frequencies
+    for (uint8_t p = SI5351_PLLA; p < SI5351_PLL_COUNT; p++) {
+        si5351_plan_pll_t* pll = &(plan->pll[p]);
+        if (pll->frequency == 0) continue;
+        uint32_t reference = si5351_get_pll_source_frequency(dev, (si5351_pll_reg_t)p);
+        uint32_t a = pll->frequency / reference;
+        si5351_get_best_fraction(pll->frequency % reference, reference, SI5351_MULTISYNTH_P3_bm, &(pll->b), &(pll->c));
+        if (pll->b == pll->c) {
+            a++;
+            pll->b = 0;
+            pll->c = 1;
+        }
+        if ((a < SI5351_PLL_INT_MIN) || (a > SI5351_PLL_INT_MAX)) goto finish;
+        pll->a = (uint8_t)a;
+        pll->error = si5351_get_vco_error(reference, pll->frequency, a, pll->b, pll->c);
+    }
+    result = SI5351_OK;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_dev_set_plan(si5351_t* dev, const si5351_plan_t* plan)
+{
+    si5351_err_t result;
+    uint8_t reset = 0;
+    si5351_dev_begin(dev);
+    SI5351_GOTO_ON_ERROR(si5351_plan_write(dev, plan, &reset), finish);
+finish:
+    if (result == SI5351_OK) {
+        result = si5351_dev_commit(dev);
+    } else {
+        si5351_dev_abort(dev);
+    }
+    if ((result == SI5351_OK) && reset) result = si5351_dev_reset_pll(dev);
+    return result;
+}
+
+// PLL and multisynth registers of the plan, reset gets the PLL_RESET bits of the PLLs written
+si5351_err_t si5351_plan_write(si5351_t* dev, const si5351_plan_t* plan, uint8_t* reset)
+{
+    si5351_err_t result = SI5351_OK;
+    for (uint8_t p = SI5351_PLLA; p < SI5351_PLL_COUNT; p++) {
+        const si5351_plan_pll_t* pll = &(plan->pll[p]);
+        if (pll->frequency == 0) continue;
+        SI5351_GOTO_ON_ERROR(si5351_dev_set_pll_vco_fractional(dev, (si5351_pll_reg_t)p, pll->a, pll->b, pll->c), finish);
+        SI5351_GOTO_ON_ERROR(si5351_dev_set_pll_mode_integer(dev, (si5351_pll_reg_t)p, (pll->b == 0) && si5351_is_even_integer(pll->a)), finish);
+        dev->pll[p].error = pll->error;
+        *reset |= (p == SI5351_PLLA) ? SI5351_PLL_RESET_PLLA_RST_bm : SI5351_PLL_RESET_PLLB_RST_bm;
+    }
+    for (uint8_t i = SI5351_MS_CLK0; i < SI5351_MS_CLK_COUNT; i++) {
+        si5351_ms_clk_reg_t clk = (si5351_ms_clk_reg_t)i;
+        const si5351_plan_clk_t* out = &(plan->clk[i]);
+        if (!out->used) continue;
+        SI5351_GOTO_ON_ERROR(si5351_dev_set_multisynth_fractional(dev, clk, out->pll, out->a, out->b, out->c), finish);
+        SI5351_GOTO_ON_ERROR(si5351_dev_set_clk_r_div(dev, clk, out->r_div), finish);
+        SI5351_GOTO_ON_ERROR(si5351_dev_set_clk_source(dev, clk, SI5351_CLK_SOURCE_MS_X), finish);
+        dev->ms[i].error = out->error;
+    }
+finish:
+    return result;
+}
+
+uint32_t si5351_plan_get_lead_vco(si5351_ms_clk_reg_t clk, uint32_t ms_frequency, uint32_t reference, uint32_t vco_min, uint32_t vco_max,
+                                  const si5351_plan_target_t* targets, const uint32_t* ms_frequencies, const bool* assigned, uint8_t count)
+{
+    uint32_t result = 0;
+    uint16_t best = 0;
+    uint32_t a_min = (clk >= SI5351_MS_CLK6) ? SI5351_MULTISYNTH_INT_0_TO_7_MIN : SI5351_MULTISYNTH_INT_0_TO_5_DIV4;
+    uint32_t a_max = (clk >= SI5351_MS_CLK6) ? SI5351_MULTISYNTH_INT_0_TO_7_MAX : SI5351_MULTISYNTH_FRAC_0_TO_5_MAX;
+    uint32_t lo = (vco_min + ms_frequency - 1) / ms_frequency;
+    uint32_t hi = vco_max / ms_frequency;
+    if (lo < a_min) lo = a_min;
+    if (hi > a_max) hi = a_max;
+    // even dividers from the highest VCO down, scored by: exact PLL fraction,
+    // other outputs that can share the PLL in even integer mode, integer PLL
+    for (uint32_t a = hi & ~1UL; a >= lo; a -= 2) {
+        uint32_t vco = a * ms_frequency;
+        uint32_t r = vco % reference;
+        uint16_t score = 1;
+        if ((reference / si5351_plan_gcd(r, reference)) <= SI5351_MULTISYNTH_P3_bm) score += 1000;
+        for (uint8_t i = 0; i < count; i++) {
+            uint16_t d;
+            if (assigned[i] || (targets[i].clk == clk)) continue;
+            if (si5351_plan_get_even_divider(targets[i].clk, vco, ms_frequencies[i], &d)) score += 10;
+        }
+        if (r == 0) score += si5351_is_even_integer(vco / reference) ? 2 : 1;
+        if (score > best) {
+            best = score;
+            result = vco;
+        }
+    }
+    return result;
+}
+
+uint32_t si5351_plan_get_vco_cap(const si5351_plan_t* plan, uint32_t vco_max, const uint32_t* ms_frequencies,
+                                 const bool* assigned, const bool* hard, uint8_t count, uint8_t lead, uint8_t* capped)
+{
+    // the lowest VCO of the largest fractional divider over the unassigned outputs
+    // that fit on none of the PLLs planned so far, capped gets the output setting it
+    uint32_t result = vco_max;
+    for (uint8_t i = 0; i < count; i++) {
+        bool fits = false;
+        if (assigned[i] || hard[i] || (i == lead)) continue;
+        for (uint8_t p = SI5351_PLLA; p < SI5351_PLL_COUNT; p++) {
+            uint16_t a;
+            uint32_t b, c;
+            if (plan->pll[p].frequency == 0) continue;
+            if (si5351_plan_get_fractional_divider(plan->pll[p].frequency, ms_frequencies[i], &a, &b, &c)) fits = true;
+        }
+        if (fits) continue;
+        uint64_t vco = (uint64_t)ms_frequencies[i] * SI5351_MULTISYNTH_FRAC_0_TO_5_MAX;
+        if (vco < result) {
+            result = (uint32_t)vco;
+            *capped = i;
+        }
+    }
+    return result;
+}
+
+bool si5351_plan_get_even_divider(si5351_ms_clk_reg_t clk, uint32_t vco, uint32_t ms_frequency, uint16_t* a)
+{
+    if (vco % ms_frequency) return false;
+    uint32_t d = vco / ms_frequency;
+    if (d % 2) return false;
+    if (clk >= SI5351_MS_CLK6) {
+        if ((d < SI5351_MULTISYNTH_INT_0_TO_7_MIN) || (d > SI5351_MULTISYNTH_INT_0_TO_7_MAX)) return false;
+    } else {
+        if ((d < SI5351_MULTISYNTH_INT_0_TO_5_DIV4) || (d > SI5351_MULTISYNTH_FRAC_0_TO_5_MAX)) return false;
+    }
+    *a = (uint16_t)d;
+    return true;
+}
+
+bool si5351_plan_get_fractional_divider(uint32_t vco, uint32_t ms_frequency, uint16_t* a, uint32_t* b, uint32_t* c)
+{
+    uint32_t d = vco / ms_frequency;
+    si5351_get_best_fraction(vco % ms_frequency, ms_frequency, SI5351_MULTISYNTH_P3_bm, b, c);
+    if (*b == *c) {
+        d++;
+        *b = 0;
+        *c = 1;
+    }
+    if ((d < SI5351_MULTISYNTH_FRAC_0_TO_5_MIN) || (d > SI5351_MULTISYNTH_FRAC_0_TO_5_MAX)) return false;
+    if ((d == SI5351_MULTISYNTH_FRAC_0_TO_5_MAX) && (*b > 0)) return false;
+    *a = (uint16_t)d;
+    return true;
+}
+
+uint8_t si5351_plan_get_output_count(si5351_variant_t variant)
+{
+    uint8_t result;
+    switch (variant) {
+        case SI5351_VARIANT_A_A_GT:
+        case SI5351_VARIANT_A_B_GT:
+            result = 3;
+            break;
+        case SI5351_VARIANT_A_B_GM1:
+        case SI5351_VARIANT_B_B_GM1:
+        case SI5351_VARIANT_C_B_GM1:
+            result = 4;
+            break;
+        default:
+            result = SI5351_MS_CLK_COUNT;
+    }
+    return result;
+}
+
+uint32_t si5351_plan_gcd(uint32_t x, uint32_t y)
+{
+    while (y != 0) {
+        uint32_t t = x % y;
+        x = y;
+        y = t;
+    }
+    return x;
+}
+
+
+si5351_err_t si5351_plan(const si5351_plan_target_t* targets, uint8_t count,
+                         const si5351_plan_constraints_t* constraints, si5351_plan_t* plan)
+{
+    return si5351_dev_plan(&chip, targets, count, constraints, plan);
+}
+
+si5351_err_t si5351_set_plan(const si5351_plan_t* plan)
+{
+    return si5351_dev_set_plan(&chip, plan);
+}
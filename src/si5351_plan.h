@@ -0,0 +1,77 @@
+/*
+ * si5351_plan.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_PLAN_H_
+#define _SI5351_PLAN_H_
+
+
+#include "si5351.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct {
+    si5351_ms_clk_reg_t clk;
+    uint32_t frequency;
+} si5351_plan_target_t;
+
+// Zero fields take the chip limits. pll_mask selects the PLLs the planner may
+// retune (bit 0 PLLA, bit 1 PLLB), PLLB is never used on VCXO (B) variants.
+typedef struct {
+    uint32_t vco_min;
+    uint32_t vco_max;
+    uint8_t pll_mask;
+    bool integer_only;
+} si5351_plan_constraints_t;
+
+typedef struct {
+    uint32_t frequency;             // 0 when the PLL is not used
+    uint8_t a;
+    uint32_t b;
+    uint32_t c;
+    int32_t error;                  // mHz, achieved minus planned VCO frequency
+} si5351_plan_pll_t;
+
+typedef struct {
+    bool used;
+    si5351_pll_reg_t pll;
+    uint16_t a;
+    uint32_t b;
+    uint32_t c;
+    si5351_clk_r_div_t r_div;
+    int32_t error;                  // mHz at the output, against the planned VCO frequency
+} si5351_plan_clk_t;
+
+typedef struct {
+    si5351_plan_pll_t pll[SI5351_PLL_COUNT];
+    si5351_plan_clk_t clk[SI5351_MS_CLK_COUNT];
+} si5351_plan_t;
+
+
+si5351_err_t si5351_dev_plan(si5351_t* dev, const si5351_plan_target_t* targets, uint8_t count,
+                             const si5351_plan_constraints_t* constraints, si5351_plan_t* plan);
+si5351_err_t si5351_dev_set_plan(si5351_t* dev, const si5351_plan_t* plan);
+
+si5351_err_t si5351_plan(const si5351_plan_target_t* targets, uint8_t count,
+                         const si5351_plan_constraints_t* constraints, si5351_plan_t* plan);
+si5351_err_t si5351_set_plan(const si5351_plan_t* plan);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_PLAN_H_
@@ -0,0 +1,80 @@
+/*
+ * si5351_private.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_PRIVATE_H_
+#define _SI5351_PRIVATE_H_
+
+
+// Library internals shared by the si5351*.c modules, not part of the API.
+
+#include "si5351.h"
+#include "si5351_plan.h"
+#include "si5351_table.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define SI5351_GOTO_ON_ERROR(x,jump) do {       \
+        result = x;                             \
+        if (result != SI5351_OK) {              \
+            goto jump;                          \
+        }                                       \
+    } while(0)
+
+#define SI5351_DIVIDE_ROUND(n, d)       (((n) + (d) / 2) / (d))
+
+
+extern si5351_t chip;
+extern const uint8_t si5351_clk_register[SI5351_MS_CLK_COUNT];
+extern const uint8_t si5351_multisynth_register[SI5351_MS_CLK_COUNT];
+extern const uint8_t si5351_pll_int_register[SI5351_PLL_COUNT];
+
+
+// si5351.c
+void si5351_get_parameters(uint8_t* data, uint32_t* p1, uint32_t* p2, uint32_t* p3);
+si5351_err_t si5351_set_parameters(uint8_t* data, uint32_t a, uint32_t b, uint32_t c);
+void si5351_put_parameters(uint8_t* data, uint32_t p1, uint32_t p2, uint32_t p3);
+uint32_t si5351_get_pll_source_frequency(si5351_t* dev, si5351_pll_reg_t pll);
+si5351_err_t si5351_read_reg(si5351_t* dev, uint8_t reg, uint8_t* data);
+si5351_err_t si5351_write_reg(si5351_t* dev, uint8_t reg, uint8_t data);
+si5351_err_t si5351_read_regs(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count);
+si5351_err_t si5351_write_regs(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count);
+si5351_err_t si5351_read_burst(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count);
+si5351_err_t si5351_i2c_read(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count);
+bool si5351_is_reg_cached(si5351_t* dev, uint8_t reg);
+bool si5351_is_reg_dirty(si5351_t* dev, uint8_t reg);
+bool si5351_is_reg_volatile(uint8_t reg);
+bool si5351_is_variant_b(si5351_variant_t variant);
+bool si5351_is_variant_c(si5351_variant_t variant);
+bool si5351_is_even_integer(uint16_t val);
+void si5351_get_best_fraction(uint64_t num, uint64_t den, uint32_t c_max, uint32_t* b, uint32_t* c);
+int32_t si5351_get_divider_error(uint64_t vco_freq, uint64_t frequency, uint32_t a, uint32_t b, uint32_t c);
+int32_t si5351_get_vco_error(uint32_t in_frequency, uint32_t frequency, uint32_t a, uint32_t b, uint32_t c);
+uint64_t si5351_get_vco_millihertz(si5351_t* dev, si5351_pll_reg_t pll);
+bool si5351_get_output_divider(si5351_ms_clk_reg_t clk, uint64_t vco_freq, uint64_t frequency, uint16_t* a, uint32_t* b, uint32_t* c);
+si5351_err_t si5351_get_integer_divider(si5351_t* dev, si5351_ms_clk_reg_t clk, uint16_t* a);
+// si5351_plan.c
+si5351_err_t si5351_plan_write(si5351_t* dev, const si5351_plan_t* plan, uint8_t* reset);
+// si5351_table.c
+si5351_err_t si5351_table_set_pll_entry(si5351_pll_reg_t pll, uint32_t in_frequency, uint64_t a, uint32_t b, uint32_t c, si5351_table_entry_t* entry);
+void si5351_table_set_state(si5351_t* dev, const si5351_table_entry_t* entry);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_PRIVATE_H_
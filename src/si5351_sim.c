@@ -0,0 +1,304 @@
+/*
+ * si5351_sim.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351_sim.h"
+#include <string.h>
+
+
+// function prototype
+si5351_err_t si5351_sim_read(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count);
+si5351_err_t si5351_sim_write(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count);
+si5351_err_t si5351_sim_write_bursts(void* ctx, uint8_t i2c_addr, si5351_burst_t* bursts, uint8_t count);
+void si5351_sim_delay_msec(void* ctx, uint32_t msec);
+uint32_t si5351_sim_get_time_usec(void* ctx);
+void si5351_sim_transfer(si5351_sim_t* sim, uint32_t messages, uint32_t reads, uint32_t bytes, uint32_t repeated_starts);
+void si5351_sim_store(si5351_sim_t* sim, uint8_t reg, uint8_t data);
+void si5351_sim_reset_pll(si5351_sim_t* sim, si5351_pll_reg_t pll);
+bool si5351_sim_is_pll_locked(si5351_sim_t* sim, si5351_pll_reg_t pll);
+double si5351_sim_get_pll_reference(si5351_sim_t* sim, si5351_pll_reg_t pll);
+double si5351_sim_get_ratio(uint8_t* data, bool integer);
+
+
+// START, STOP and repeated START are one bit each, every byte is 8 bits plus ACK
+#define SI5351_SIM_BYTE_BITS            9
+#define SI5351_SIM_TIMER_READ_nsec      1000
+#define SI5351_SIM_LOL_bm               (SI5351_DEVICE_STATUS_LOL_A_bm | SI5351_DEVICE_STATUS_LOL_B_bm)
+
+const uint8_t si5351_sim_lol_bm[SI5351_PLL_COUNT] = {
+    SI5351_DEVICE_STATUS_LOL_A_bm, SI5351_DEVICE_STATUS_LOL_B_bm
+};
+
+
+void si5351_sim_open(si5351_bus_t* bus, si5351_sim_t* sim, uint8_t i2c_address, uint32_t xtal_freq, uint32_t clkin_freq)
+{
+    memset(sim, 0, sizeof(si5351_sim_t));
+    sim->i2c_address = i2c_address;
+    sim->xtal_freq = xtal_freq;
+    sim->clkin_freq = clkin_freq;
+    sim->scl_hz = SI5351_SIM_SCL_DEFAULT;
+    sim->powerup_usec = SI5351_POWERUP_TIME_ms * 1000 / 2;
+    sim->lock_time_usec = SI5351_SIM_LOCK_TIME_DEFAULT_usec;
+    si5351_sim_power_cycle(sim);
+    // the chip has been powered long before the host starts talking to it
+    sim->sys_init_until_nsec = 0;
+    sim->pll_lock_at_nsec[SI5351_PLLA] = 0;
+    sim->pll_lock_at_nsec[SI5351_PLLB] = 0;
+    sim->regs[SI5351_INTERRUPT_STATUS_STICKY] = 0;
+    bus->read = si5351_sim_read;
+    bus->write = si5351_sim_write;
+    bus->write_bursts = si5351_sim_write_bursts;
+    bus->delay_msec = si5351_sim_delay_msec;
+    bus->get_time_usec = si5351_sim_get_time_usec;
+    bus->ctx = sim;
+}
+
+void si5351_sim_power_cycle(si5351_sim_t* sim)
+{
+    // blank NVM: all outputs disabled and powered down, 10 pF crystal load
+    memset(sim->regs, 0, sizeof(sim->regs));
+    sim->regs[SI5351_OUTPUT_ENABLE_CONTROL] = 0xFF;
+    for (uint8_t reg = SI5351_CLK0_CONTROL; reg <= SI5351_CLK7_CONTROL; reg++) {
+        sim->regs[reg] = SI5351_CLK_CONTROL_CLK_PDN_bm;
+    }
+    sim->regs[SI5351_CRYSTAL_INTERNAL_LOAD_CAP] = SI5351_CRYSTAL_INTERNAL_LOAD_CAP_XTAL_10PF_bm | SI5351_CRYSTAL_INTERNAL_LOAD_CAP_RESERVED_bm;
+    sim->regs[SI5351_INTERRUPT_STATUS_STICKY] = SI5351_DEVICE_STATUS_SYS_INIT_bm | SI5351_SIM_LOL_bm;
+    sim->sys_init_until_nsec = sim->time_nsec + (uint64_t)sim->powerup_usec * 1000;
+    for (int i = SI5351_PLLA; i < SI5351_PLL_COUNT; i++) {
+        sim->pll_lock_at_nsec[i] = sim->sys_init_until_nsec + (uint64_t)sim->lock_time_usec * 1000;
+    }
+}
+
+void si5351_sim_advance_usec(si5351_sim_t* sim, uint32_t usec)
+{
+    sim->time_nsec += (uint64_t)usec * 1000;
+}
+
+void si5351_sim_reset_stats(si5351_sim_t* sim)
+{
+    memset(&(sim->stats), 0, sizeof(si5351_sim_stats_t));
+}
+
+uint64_t si5351_sim_bus_nsec(const si5351_sim_stats_t* stats, uint32_t scl_hz)
+{
+    if (scl_hz == 0) return 0;
+    return (stats->bits * 1000000000ULL + scl_hz - 1) / scl_hz;
+}
+
+uint8_t si5351_sim_get_status(si5351_sim_t* sim)
+{
+    uint8_t status = SI5351_REVISION_B;
+    if (sim->time_nsec < sim->sys_init_until_nsec) status |= SI5351_DEVICE_STATUS_SYS_INIT_bm;
+    if (sim->xtal_freq == 0) status |= SI5351_DEVICE_STATUS_LOS_XTAL_bm;
+    if (sim->clkin_freq == 0) status |= SI5351_DEVICE_STATUS_LOS_CLKIN_bm;
+    for (int i = SI5351_PLLA; i < SI5351_PLL_COUNT; i++) {
+        if (!si5351_sim_is_pll_locked(sim, i)) status |= si5351_sim_lol_bm[i];
+    }
+    sim->regs[SI5351_INTERRUPT_STATUS_STICKY] |= status & ~SI5351_DEVICE_STATUS_REVID_bm;
+    return status;
+}
+
+bool si5351_sim_get_intr(si5351_sim_t* sim)
+{
+    // INTR is asserted while a sticky bit is set and not masked
+    si5351_sim_get_status(sim);
+    return (sim->regs[SI5351_INTERRUPT_STATUS_STICKY] & ~sim->regs[SI5351_INTERRUPT_STATUS_MASK] & ~SI5351_DEVICE_STATUS_REVID_bm) != 0;
+}
+
+double si5351_sim_get_pll_frequency(si5351_sim_t* sim, si5351_pll_reg_t pll)
+{
+    uint8_t pll_reg = (pll == SI5351_PLLA) ? SI5351_MULTISYNTH_NA_PARAMETERS : SI5351_MULTISYNTH_NB_PARAMETERS;
+    uint8_t control = sim->regs[(pll == SI5351_PLLA) ? SI5351_CLK6_CONTROL : SI5351_CLK7_CONTROL];
+    return si5351_sim_get_pll_reference(sim, pll) * si5351_sim_get_ratio(&(sim->regs[pll_reg]), (control & SI5351_CLK_CONTROL_FB_INT_bm) != 0);
+}
+
+double si5351_sim_get_ms_frequency(si5351_sim_t* sim, si5351_ms_clk_reg_t ms)
+{
+    uint8_t control = sim->regs[SI5351_CLK0_CONTROL + ms];
+    double vco = si5351_sim_get_pll_frequency(sim, (control & SI5351_CLK_CONTROL_MS_SRC_bm) ? SI5351_PLLB : SI5351_PLLA);
+    double divider;
+    if ((ms == SI5351_MS_CLK6) || (ms == SI5351_MS_CLK7)) {
+        divider = sim->regs[SI5351_MULTISYNTH6_PARAMETERS + ms - SI5351_MS_CLK6];
+    } else {
+        uint8_t* data = &(sim->regs[SI5351_MULTISYNTH0_PARAMETERS + ms * SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH]);
+        if ((data[2] & SI5351_MULTISYNTH0_PARAMETERS_MS_DIV4_bm) == SI5351_MULTISYNTH0_PARAMETERS_MS_DIV4_bm) {
+            divider = SI5351_MULTISYNTH_INT_0_TO_5_DIV4;
+        } else {
+            divider = si5351_sim_get_ratio(data, (control & SI5351_CLK_CONTROL_MS_INT_bm) != 0);
+        }
+    }
+    if (divider == 0) return 0;
+    return vco / divider;
+}
+
+double si5351_sim_get_clk_frequency(si5351_sim_t* sim, si5351_ms_clk_reg_t clk)
+{
+    uint8_t control = sim->regs[SI5351_CLK0_CONTROL + clk];
+    uint8_t fanout = sim->regs[SI5351_FANOUT_ENABLE];
+    if (control & SI5351_CLK_CONTROL_CLK_PDN_bm) return 0;
+    if (sim->regs[SI5351_OUTPUT_ENABLE_CONTROL] & (1 << clk)) return 0;
+    double frequency = 0;
+    switch (control & SI5351_CLK_CONTROL_CLK_SRC_bm) {
+        case SI5351_CLK_CONTROL_CLK_SRC_XTAL_bm:
+            if (fanout & SI5351_FANOUT_ENABLE_XO_bm) frequency = sim->xtal_freq;
+            break;
+        case SI5351_CLK_CONTROL_CLK_SRC_CLKIN_bm:
+            if (fanout & SI5351_FANOUT_ENABLE_CLKIN_bm) frequency = sim->clkin_freq;
+            break;
+        case SI5351_CLK_CONTROL_CLK_SRC_MULTISYNTH_0_OR_4_bm:
+            if (fanout & SI5351_FANOUT_ENABLE_MS_bm) {
+                frequency = si5351_sim_get_ms_frequency(sim, (clk < SI5351_MS_CLK4) ? SI5351_MS_CLK0 : SI5351_MS_CLK4);
+            }
+            break;
+        default:
+            frequency = si5351_sim_get_ms_frequency(sim, clk);
+    }
+    uint8_t r;
+    switch (clk) {
+        case SI5351_MS_CLK6:
+            r = (sim->regs[SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER] & SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R6_DIV_bm) >> SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R6_DIV_bp;
+            break;
+        case SI5351_MS_CLK7:
+            r = (sim->regs[SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER] & SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R7_DIV_bm) >> SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER_R7_DIV_bp;
+            break;
+        default:
+            r = (sim->regs[SI5351_MULTISYNTH0_PARAMETERS + clk * SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH + 2]
+                    & SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm) >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp;
+    }
+    return frequency / (1 << r);
+}
+
+si5351_err_t si5351_sim_read(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    si5351_sim_t* sim = (si5351_sim_t*)ctx;
+    if (i2c_addr != sim->i2c_address) {
+        si5351_sim_transfer(sim, 1, 0, 1, 0);
+        return SI5351_ERR_FAIL;
+    }
+    // address + register, repeated START, address + data
+    si5351_sim_transfer(sim, 2, 1, 3 + count, 1);
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t addr = (uint8_t)(reg + i);
+        if (addr == SI5351_DEVICE_STATUS) {
+            data[i] = si5351_sim_get_status(sim);
+        } else {
+            if (addr == SI5351_INTERRUPT_STATUS_STICKY) si5351_sim_get_status(sim);
+            data[i] = sim->regs[addr];
+        }
+    }
+    return SI5351_OK;
+}
+
+si5351_err_t si5351_sim_write(void* ctx, uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t count)
+{
+    si5351_burst_t burst = { .reg = reg, .count = count, .data = data };
+    return si5351_sim_write_bursts(ctx, i2c_addr, &burst, 1);
+}
+
+si5351_err_t si5351_sim_write_bursts(void* ctx, uint8_t i2c_addr, si5351_burst_t* bursts, uint8_t count)
+{
+    si5351_sim_t* sim = (si5351_sim_t*)ctx;
+    if (i2c_addr != sim->i2c_address) {
+        si5351_sim_transfer(sim, 1, 0, 1, 0);
+        return SI5351_ERR_FAIL;
+    }
+    // one combined transfer, bursts joined by repeated START
+    uint32_t bytes = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        bytes += 2 + bursts[i].count;
+    }
+    si5351_sim_transfer(sim, count, 0, bytes, (count > 0) ? count - 1 : 0);
+    for (uint8_t i = 0; i < count; i++) {
+        for (uint8_t j = 0; j < bursts[i].count; j++) {
+            si5351_sim_store(sim, (uint8_t)(bursts[i].reg + j), bursts[i].data[j]);
+        }
+    }
+    return SI5351_OK;
+}
+
+void si5351_sim_delay_msec(void* ctx, uint32_t msec)
+{
+    si5351_sim_t* sim = (si5351_sim_t*)ctx;
+    sim->time_nsec += (uint64_t)msec * 1000000;
+}
+
+uint32_t si5351_sim_get_time_usec(void* ctx)
+{
+    si5351_sim_t* sim = (si5351_sim_t*)ctx;
+    // reading the timer takes time too, a busy wait on it ends
+    sim->time_nsec += SI5351_SIM_TIMER_READ_nsec;
+    return (uint32_t)(sim->time_nsec / 1000);
+}
+
+void si5351_sim_transfer(si5351_sim_t* sim, uint32_t messages, uint32_t reads, uint32_t bytes, uint32_t repeated_starts)
+{
+    uint64_t bits = 2 + repeated_starts + (uint64_t)bytes * SI5351_SIM_BYTE_BITS;
+    sim->stats.transactions++;
+    sim->stats.reads += reads;
+    sim->stats.writes += messages - reads;
+    sim->stats.bytes += bytes;
+    sim->stats.bits += bits;
+    if (sim->scl_hz) sim->time_nsec += (bits * 1000000000ULL + sim->scl_hz - 1) / sim->scl_hz;
+}
+
+void si5351_sim_store(si5351_sim_t* sim, uint8_t reg, uint8_t data)
+{
+    switch (reg) {
+        case SI5351_DEVICE_STATUS:
+            // read only
+            break;
+        case SI5351_PLL_RESET:
+            // self-clearing
+            if (data & SI5351_PLL_RESET_PLLA_RST_bm) si5351_sim_reset_pll(sim, SI5351_PLLA);
+            if (data & SI5351_PLL_RESET_PLLB_RST_bm) si5351_sim_reset_pll(sim, SI5351_PLLB);
+            break;
+        case SI5351_INTERRUPT_STATUS_STICKY:
+            // a written 0 clears the bit, a written 1 leaves it
+            sim->regs[reg] &= data;
+            break;
+        default:
+            sim->regs[reg] = data;
+    }
+}
+
+void si5351_sim_reset_pll(si5351_sim_t* sim, si5351_pll_reg_t pll)
+{
+    sim->pll_lock_at_nsec[pll] = sim->time_nsec + (uint64_t)sim->lock_time_usec * 1000;
+    sim->pll_resets[pll]++;
+    sim->regs[SI5351_INTERRUPT_STATUS_STICKY] |= si5351_sim_lol_bm[pll];
+}
+
+bool si5351_sim_is_pll_locked(si5351_sim_t* sim, si5351_pll_reg_t pll)
+{
+    if (sim->time_nsec < sim->pll_lock_at_nsec[pll]) return false;
+    double reference = si5351_sim_get_pll_reference(sim, pll);
+    if ((reference < SI5351_PLL_CLKIN_MIN) || (reference > SI5351_PLL_CLKIN_MAX)) return false;
+    double vco = si5351_sim_get_pll_frequency(sim, pll);
+    return (vco >= SI5351_PLL_VCO_MIN) && (vco <= SI5351_PLL_VCO_MAX);
+}
+
+double si5351_sim_get_pll_reference(si5351_sim_t* sim, si5351_pll_reg_t pll)
+{
+    uint8_t source = sim->regs[SI5351_PLL_INPUT_SOURCE];
+    uint8_t src_bm = (pll == SI5351_PLLA) ? SI5351_PLL_INPUT_SOURCE_PLLA_SRC_bm : SI5351_PLL_INPUT_SOURCE_PLLB_SRC_bm;
+    if (!(source & src_bm)) return sim->xtal_freq;
+    return (double)sim->clkin_freq / (1 << ((source & SI5351_PLL_INPUT_SOURCE_CLKIN_DIV_bm) >> SI5351_PLL_INPUT_SOURCE_CLKIN_DIV_bp));
+}
+
+double si5351_sim_get_ratio(uint8_t* data, bool integer)
+{
+    // a + b / c = ((p1 + 512) * p3 + p2) / (128 * p3), integer mode drops the fraction
+    uint32_t p3 = ((uint32_t)(data[5] & 0xF0) << 12) | ((uint32_t)data[0] << 8) | data[1];
+    uint32_t p1 = ((uint32_t)(data[2] & 0x03) << 16) | ((uint32_t)data[3] << 8) | data[4];
+    uint32_t p2 = ((uint32_t)(data[5] & 0x0F) << 16) | ((uint32_t)data[6] << 8) | data[7];
+    if (p3 == 0) return 0;
+    if (integer) return (p1 + 512) / 128;
+    return ((double)(p1 + 512) * p3 + p2) / (128.0 * p3);
+}
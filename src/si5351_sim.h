@@ -0,0 +1,75 @@
+/*
+ * si5351_sim.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_SIM_H_
+#define _SI5351_SIM_H_
+
+
+#include "si5351.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define SI5351_SIM_REGISTER_COUNT           256
+#define SI5351_SIM_SCL_DEFAULT              400000UL
+#define SI5351_SIM_LOCK_TIME_DEFAULT_usec   (500)
+
+// Bus traffic as it would appear on the wire. bits counts every START, STOP,
+// address, register and data bit including ACKs, so the time of the same
+// traffic at any SCL rate is bits / scl.
+typedef struct {
+    uint32_t transactions;
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t bytes;
+    uint64_t bits;
+} si5351_sim_stats_t;
+
+// Virtual Si5351 on a virtual I2C bus. The simulated time advances with every
+// bus transfer (at scl_hz), with every delay_msec() and by 1 us per get_time_usec().
+typedef struct {
+    uint8_t regs[SI5351_SIM_REGISTER_COUNT];
+    uint8_t i2c_address;
+    uint32_t xtal_freq;
+    uint32_t clkin_freq;
+    uint32_t scl_hz;
+    uint32_t powerup_usec;
+    uint32_t lock_time_usec;
+    uint64_t time_nsec;
+    uint64_t sys_init_until_nsec;
+    uint64_t pll_lock_at_nsec[SI5351_PLL_COUNT];
+    uint32_t pll_resets[SI5351_PLL_COUNT];
+    si5351_sim_stats_t stats;
+} si5351_sim_t;
+
+
+void si5351_sim_open(si5351_bus_t* bus, si5351_sim_t* sim, uint8_t i2c_address, uint32_t xtal_freq, uint32_t clkin_freq);
+void si5351_sim_power_cycle(si5351_sim_t* sim);
+void si5351_sim_advance_usec(si5351_sim_t* sim, uint32_t usec);
+void si5351_sim_reset_stats(si5351_sim_t* sim);
+uint64_t si5351_sim_bus_nsec(const si5351_sim_stats_t* stats, uint32_t scl_hz);
+uint8_t si5351_sim_get_status(si5351_sim_t* sim);
+bool si5351_sim_get_intr(si5351_sim_t* sim);
+double si5351_sim_get_pll_frequency(si5351_sim_t* sim, si5351_pll_reg_t pll);
+double si5351_sim_get_ms_frequency(si5351_sim_t* sim, si5351_ms_clk_reg_t ms);
+double si5351_sim_get_clk_frequency(si5351_sim_t* sim, si5351_ms_clk_reg_t clk);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_SIM_H_
@@ -0,0 +1,219 @@
+/*
+ * si5351_snapshot.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351_snapshot.h"
+#include "si5351_private.h"
+#include <string.h>
+
+
+// function prototype
+void si5351_snapshot_put32(uint8_t* data, uint32_t value);
+uint32_t si5351_snapshot_get32(const uint8_t* data);
+uint16_t si5351_snapshot_crc(const uint8_t* data, uint16_t length);
+bool si5351_snapshot_is_state_valid(const uint8_t* data);
+
+
+// layout: magic, version, variant, crystal and CLKIN frequency, CLKIN divider,
+// fanout, crystal load, PLLA and PLLB, MS0..MS7, the register blocks, CRC
+#define SI5351_SNAPSHOT_MAGIC_0         0x53
+#define SI5351_SNAPSHOT_MAGIC_1         0x35
+#define SI5351_SNAPSHOT_CHIP_LENGTH     12
+#define SI5351_SNAPSHOT_PLL_LENGTH      9
+#define SI5351_SNAPSHOT_MS_LENGTH       10
+#define SI5351_SNAPSHOT_BLOCKS          6
+#define SI5351_SNAPSHOT_CRC_POLYNOMIAL  0x1021
+
+
+// first register and count, 105 registers
+const uint8_t si5351_snapshot_block[SI5351_SNAPSHOT_BLOCKS][2] = {
+    { SI5351_INTERRUPT_STATUS_MASK, 2 },
+    { SI5351_OEB_PIN_ENABLE_CONTROL_MASK, 1 },
+    { SI5351_PLL_INPUT_SOURCE, SI5351_CLOCK_6_AND_7_OUTPUT_DIVIDER - SI5351_PLL_INPUT_SOURCE + 1 },
+    { SI5351_SPREAD_SPECTRUM_PARAMETERS, SI5351_CLK5_INITIAL_PHASE_OFFSET - SI5351_SPREAD_SPECTRUM_PARAMETERS + 1 },
+    { SI5351_CRYSTAL_INTERNAL_LOAD_CAP, 1 },
+    { SI5351_FANOUT_ENABLE, 1 }
+};
+
+
+si5351_err_t si5351_dev_snapshot_export(si5351_t* dev, uint8_t* data, uint16_t size, uint16_t* length)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((data == NULL) || (size < SI5351_SNAPSHOT_LENGTH)) goto finish;
+    if (!dev->initialised) {
+        result = SI5351_ERR_NOT_INITIALISED;
+        goto finish;
+    }
+    uint8_t* p = data;
+    *p++ = SI5351_SNAPSHOT_MAGIC_0;
+    *p++ = SI5351_SNAPSHOT_MAGIC_1;
+    *p++ = SI5351_SNAPSHOT_VERSION;
+    *p++ = (uint8_t)dev->variant;
+    si5351_snapshot_put32(p, dev->crystal_freq);
+    si5351_snapshot_put32(p + 4, dev->clkin_freq);
+    p += 8;
+    *p++ = dev->clkin_divider;
+    *p++ = dev->fanout_bm;
+    *p++ = (uint8_t)dev->crystal_load;
+    for (uint8_t i = SI5351_PLLA; i < SI5351_PLL_COUNT; i++) {
+        *p++ = (dev->pll[i].configured ? 0x01 : 0x00) | (uint8_t)(dev->pll[i].source << 1);
+        si5351_snapshot_put32(p, dev->pll[i].frequency);
+        si5351_snapshot_put32(p + 4, (uint32_t)dev->pll[i].error);
+        p += 8;
+    }
+    for (uint8_t i = SI5351_MS_CLK0; i < SI5351_MS_CLK_COUNT; i++) {
+        *p++ = (dev->ms[i].configured ? 0x01 : 0x00) | (uint8_t)(dev->ms[i].pll << 1);
+        *p++ = (uint8_t)dev->ms[i].r_div;
+        si5351_snapshot_put32(p, dev->ms[i].frequency);
+        si5351_snapshot_put32(p + 4, (uint32_t)dev->ms[i].error);
+        p += 8;
+    }
+    // from the register shadow, the bus is read only for registers not known yet
+    for (uint8_t i = 0; i < SI5351_SNAPSHOT_BLOCKS; i++) {
+        SI5351_GOTO_ON_ERROR(si5351_read_regs(dev, si5351_snapshot_block[i][0], p, si5351_snapshot_block[i][1]), finish);
+        p += si5351_snapshot_block[i][1];
+    }
+    uint16_t crc = si5351_snapshot_crc(data, SI5351_SNAPSHOT_LENGTH - 2);
+    *p++ = (uint8_t)crc;
+    *p++ = (uint8_t)(crc >> 8);
+    if (length != NULL) *length = SI5351_SNAPSHOT_LENGTH;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_dev_snapshot_import(si5351_t* dev, const uint8_t* data, uint16_t length)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((data == NULL) || (length < SI5351_SNAPSHOT_LENGTH)) goto finish;
+    if ((data[0] != SI5351_SNAPSHOT_MAGIC_0) || (data[1] != SI5351_SNAPSHOT_MAGIC_1) || (data[2] != SI5351_SNAPSHOT_VERSION)) goto finish;
+    uint16_t crc = data[SI5351_SNAPSHOT_LENGTH - 2] | ((uint16_t)data[SI5351_SNAPSHOT_LENGTH - 1] << 8);
+    if (crc != si5351_snapshot_crc(data, SI5351_SNAPSHOT_LENGTH - 2)) goto finish;
+    if (!dev->initialised) {
+        result = SI5351_ERR_NOT_INITIALISED;
+        goto finish;
+    }
+    const uint8_t* p = &(data[3]);
+    // a snapshot of another chip or clock setup
+    if ((p[0] != (uint8_t)dev->variant) || (si5351_snapshot_get32(p + 1) != dev->crystal_freq) || (si5351_snapshot_get32(p + 5) != dev->clkin_freq)) {
+        result = SI5351_ERR_INVALID_STATE;
+        goto finish;
+    }
+    // the CRC only covers storage errors, the decoded state is checked before anything is written
+    if (!si5351_snapshot_is_state_valid(p + 9)) goto finish;
+    const uint8_t* regs = &(data[3 + SI5351_SNAPSHOT_CHIP_LENGTH + SI5351_PLL_COUNT * SI5351_SNAPSHOT_PLL_LENGTH + SI5351_MS_CLK_COUNT * SI5351_SNAPSHOT_MS_LENGTH]);
+    uint8_t output_enable = regs[SI5351_OUTPUT_ENABLE_CONTROL - SI5351_INTERRUPT_STATUS_MASK];
+    uint8_t current;
+    SI5351_GOTO_ON_ERROR(si5351_read_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, &current), finish);
+    if (current != 0xFF) SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, 0xFF), finish);
+    // registers equal to the shadow are skipped, the commit joins the rest into the fewest bursts
+    si5351_dev_begin(dev);
+    for (uint8_t i = 0; i < SI5351_SNAPSHOT_BLOCKS; i++) {
+        for (uint8_t n = 0; n < si5351_snapshot_block[i][1]; n++) {
+            uint8_t reg = si5351_snapshot_block[i][0] + n;
+            if (reg == SI5351_OUTPUT_ENABLE_CONTROL) continue;
+            result = si5351_write_reg(dev, reg, regs[n]);
+            if (result != SI5351_OK) break;
+        }
+        if (result != SI5351_OK) break;
+        regs += si5351_snapshot_block[i][1];
+    }
+    if (result == SI5351_OK) {
+        result = si5351_dev_commit(dev);
+    } else {
+        si5351_dev_abort(dev);
+    }
+    if (result != SI5351_OK) goto finish;
+    p += 9;
+    dev->clkin_divider = *p++;
+    dev->fanout_bm = *p++;
+    dev->crystal_load = (si5351_crystal_load_t)*p++;
+    uint8_t pll_mask = 0;
+    for (uint8_t i = SI5351_PLLA; i < SI5351_PLL_COUNT; i++) {
+        dev->pll[i].configured = (*p & 0x01) != 0;
+        dev->pll[i].source = (si5351_pll_source_t)(*p++ >> 1);
+        dev->pll[i].frequency = si5351_snapshot_get32(p);
+        dev->pll[i].error = (int32_t)si5351_snapshot_get32(p + 4);
+        p += 8;
+        if (dev->pll[i].configured) pll_mask |= (1 << i);
+    }
+    for (uint8_t i = SI5351_MS_CLK0; i < SI5351_MS_CLK_COUNT; i++) {
+        dev->ms[i].configured = (*p & 0x01) != 0;
+        dev->ms[i].pll = (si5351_pll_reg_t)(*p++ >> 1);
+        dev->ms[i].r_div = (si5351_clk_r_div_t)*p++;
+        dev->ms[i].frequency = si5351_snapshot_get32(p);
+        dev->ms[i].error = (int32_t)si5351_snapshot_get32(p + 4);
+        p += 8;
+    }
+    SI5351_GOTO_ON_ERROR(si5351_dev_reset_pll(dev), finish);
+    if (output_enable == 0xFF) goto finish;
+    if (pll_mask != 0) SI5351_GOTO_ON_ERROR(si5351_dev_wait_lock(dev, pll_mask, SI5351_PLL_LOCK_TIME_ms * 1000UL, NULL), finish);
+    SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, output_enable), finish);
+finish:
+    return result;
+}
+
+// data at the CLKIN divider, every field that becomes an enum or an index is in range
+bool si5351_snapshot_is_state_valid(const uint8_t* data)
+{
+    // 0 is a CLKIN divider never set
+    uint8_t divider = *data++;
+    if ((divider > 8) || ((divider & (divider - 1)) != 0)) return false;
+    if ((*data++ & ~(SI5351_FANOUT_ENABLE_CLKIN_bm | SI5351_FANOUT_ENABLE_XO_bm | SI5351_FANOUT_ENABLE_MS_bm)) != 0) return false;
+    if ((*data++ & ~SI5351_CRYSTAL_INTERNAL_LOAD_CAP_XTAL_CL_bm) != 0) return false;
+    for (uint8_t i = SI5351_PLLA; i < SI5351_PLL_COUNT; i++) {
+        if ((*data >> 1) > SI5351_PLL_CLKINT) return false;
+        data += SI5351_SNAPSHOT_PLL_LENGTH;
+    }
+    for (uint8_t i = SI5351_MS_CLK0; i < SI5351_MS_CLK_COUNT; i++) {
+        if ((data[0] >> 1) >= SI5351_PLL_COUNT) return false;
+        if ((data[1] & ~SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm) != 0) return false;
+        data += SI5351_SNAPSHOT_MS_LENGTH;
+    }
+    return true;
+}
+
+void si5351_snapshot_put32(uint8_t* data, uint32_t value)
+{
+    for (uint8_t i = 0; i < 4; i++) {
+        data[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+uint32_t si5351_snapshot_get32(const uint8_t* data)
+{
+    uint32_t result = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        result |= (uint32_t)data[i] << (8 * i);
+    }
+    return result;
+}
+
+// CRC-16/CCITT-FALSE, bitwise to keep the table out of flash
+uint16_t si5351_snapshot_crc(const uint8_t* data, uint16_t length)
+{
+    uint16_t result = 0xFFFF;
+    for (uint16_t i = 0; i < length; i++) {
+        result ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            result = (result & 0x8000) ? (uint16_t)((result << 1) ^ SI5351_SNAPSHOT_CRC_POLYNOMIAL) : (uint16_t)(result << 1);
+        }
+    }
+    return result;
+}
+
+si5351_err_t si5351_snapshot_export(uint8_t* data, uint16_t size, uint16_t* length)
+{
+    return si5351_dev_snapshot_export(&chip, data, size, length);
+}
+
+si5351_err_t si5351_snapshot_import(const uint8_t* data, uint16_t length)
+{
+    return si5351_dev_snapshot_import(&chip, data, length);
+}
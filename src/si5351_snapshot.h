@@ -0,0 +1,48 @@
+/*
+ * si5351_snapshot.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_SNAPSHOT_H_
+#define _SI5351_SNAPSHOT_H_
+
+
+#include "si5351.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define SI5351_SNAPSHOT_VERSION         1
+#define SI5351_SNAPSHOT_LENGTH          220
+
+
+// A snapshot is the configuration registers (2, 3, 9, 15..92, 149..170, 183
+// and 187) with the PLL and multisynth state of si5351_t, little endian and
+// closed by a CRC-16, for NVS or EEPROM. Import checks the version, the CRC,
+// that the variant, crystal and CLKIN match the handle (initialised with
+// si5351_init()) and that the PLL and multisynth state is in range, then
+// writes the registers that differ from the shadow in one commit, resets the
+// PLLs and enables the outputs once they are locked.
+si5351_err_t si5351_dev_snapshot_export(si5351_t* dev, uint8_t* data, uint16_t size, uint16_t* length);
+si5351_err_t si5351_dev_snapshot_import(si5351_t* dev, const uint8_t* data, uint16_t length);
+
+si5351_err_t si5351_snapshot_export(uint8_t* data, uint16_t size, uint16_t* length);
+si5351_err_t si5351_snapshot_import(const uint8_t* data, uint16_t length);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_SNAPSHOT_H_
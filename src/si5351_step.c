@@ -0,0 +1,199 @@
+/*
+ * si5351_step.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351_step.h"
+#include "si5351_private.h"
+
+
+// function prototype
+void si5351_step_split(uint64_t numerator, uint32_t denominator, si5351_step_value_t* value);
+void si5351_step_move(si5351_step_value_t* value, const si5351_step_value_t* delta, bool down);
+void si5351_step_update_state(si5351_t* dev, si5351_step_t* step);
+
+
+si5351_err_t si5351_dev_step_init(si5351_t* dev, si5351_step_t* step, si5351_ms_clk_reg_t clk, uint64_t frequency, int64_t delta)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((step == NULL) || (delta == 0)) goto finish;
+    if ((clk < SI5351_MS_CLK0) || (clk >= SI5351_MS_CLK_COUNT)) goto finish;
+    if (!dev->initialised || !dev->ms[clk].configured || !dev->pll[dev->ms[clk].pll].configured) {
+        result = SI5351_ERR_NOT_INITIALISED;
+        goto finish;
+    }
+    si5351_pll_reg_t pll = dev->ms[clk].pll;
+    // PLLB of the B variant is the VCXO PLL, its fraction is fixed
+    if ((pll == SI5351_PLLB) && si5351_is_variant_b(dev->variant)) goto finish;
+    uint16_t divider;
+    SI5351_GOTO_ON_ERROR(si5351_get_integer_divider(dev, clk, &divider), finish);
+    result = SI5351_ERR_INVALID_ARG;
+    uint8_t r = dev->ms[clk].r_div >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp;
+    uint64_t reference = (uint64_t)si5351_get_pll_source_frequency(dev, pll) * 1000;
+    uint64_t vco_delta = (uint64_t)((delta < 0) ? -delta : delta) * divider << r;
+    uint64_t vco_freq = frequency * divider << r;
+    if ((vco_delta >= reference) || (frequency == 0)) goto finish;
+    // delta_b / c ~ vco_delta / reference, c scaled up as far as P3 allows for the finest start
+    uint32_t delta_b, c;
+    si5351_get_best_fraction(vco_delta, reference, SI5351_MULTISYNTH_P3_bm, &delta_b, &c);
+    if (delta_b == 0) goto finish;
+    uint32_t scale = SI5351_MULTISYNTH_P3_bm / c;
+    delta_b *= scale;
+    c *= scale;
+    uint32_t a = (uint32_t)(vco_freq / reference);
+    uint32_t b = (uint32_t)SI5351_DIVIDE_ROUND((vco_freq % reference) * c, reference);
+    if (b == c) {
+        a++;
+        b = 0;
+    }
+    if ((a < SI5351_PLL_INT_MIN) || (a > SI5351_PLL_INT_MAX)) goto finish;
+#if (SI5351_ALLOW_OVERCLOCKING == 0)
+    uint64_t vco_min = (uint64_t)SI5351_PLL_VCO_MIN * 1000;
+    uint64_t vco_max = (uint64_t)SI5351_PLL_VCO_MAX * 1000;
+#else
+    uint64_t vco_min = reference * SI5351_PLL_INT_MIN;
+    uint64_t vco_max = reference * SI5351_PLL_INT_MAX;
+#endif
+    uint64_t vco_start = reference * a + (reference * b) / c;
+    uint64_t vco_step = (reference * delta_b) / c;
+    if ((vco_start < vco_min) || (vco_start > vco_max)) goto finish;
+    // VCO and multisynth output in mHz as whole parts and remainders, moved by additions only
+    si5351_step_split(reference * ((uint64_t)a * c + b), c, &(step->vco));
+    si5351_step_split(reference * delta_b, c, &(step->vco_step));
+    si5351_step_split(reference * ((uint64_t)a * c + b), c * divider, &(step->ms));
+    si5351_step_split(reference * delta_b, c * divider, &(step->ms_step));
+    // rounded up, a step never leaves the VCO range
+    uint64_t steps_left = (delta < 0) ? (vco_start - vco_min) / (vco_step + 1) : (vco_max - vco_start) / (vco_step + 1);
+    step->steps_left = (steps_left > UINT32_MAX) ? UINT32_MAX : (uint32_t)steps_left;
+    step->pll = pll;
+    step->clk = clk;
+    step->down = (delta < 0);
+    step->p3 = c;
+    step->p1 = 128 * a + (128 * b) / c - 512;
+    step->p2 = (128 * b) % c;
+    step->step_p1 = (128 * delta_b) / c;
+    step->step_p2 = (128 * delta_b) % c;
+    si5351_put_parameters(step->data, step->p1, step->p2, step->p3);
+    si5351_dev_begin(dev);
+    SI5351_GOTO_ON_ERROR(si5351_dev_set_pll_mode_integer(dev, pll, false), commit);
+    SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, (pll == SI5351_PLLA) ? SI5351_MULTISYNTH_NA_PARAMETERS : SI5351_MULTISYNTH_NB_PARAMETERS,
+            step->data, SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH), commit);
+commit:
+    if (result == SI5351_OK) {
+        result = si5351_dev_commit(dev);
+    } else {
+        si5351_dev_abort(dev);
+    }
+    if (result == SI5351_OK) si5351_step_update_state(dev, step);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_dev_step(si5351_t* dev, si5351_step_t* step)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((step == NULL) || (step->steps_left == 0)) goto finish;
+    if (step->down) {
+        if (step->p2 < step->step_p2) {
+            step->p2 += step->p3;
+            step->p1--;
+        }
+        step->p2 -= step->step_p2;
+        step->p1 -= step->step_p1;
+    } else {
+        step->p2 += step->step_p2;
+        if (step->p2 >= step->p3) {
+            step->p2 -= step->p3;
+            step->p1++;
+        }
+        step->p1 += step->step_p1;
+    }
+    step->steps_left--;
+    // only the registers between the first and the last changed byte
+    uint8_t data[SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH];
+    si5351_put_parameters(data, step->p1, step->p2, step->p3);
+    uint8_t first = 0;
+    uint8_t last = SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH;
+    while ((first < last) && (data[first] == step->data[first])) first++;
+    while ((last > first) && (data[last - 1] == step->data[last - 1])) last--;
+    result = SI5351_OK;
+    if (first < last) {
+        uint8_t reg = (step->pll == SI5351_PLLA) ? SI5351_MULTISYNTH_NA_PARAMETERS : SI5351_MULTISYNTH_NB_PARAMETERS;
+        SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, reg + first, &(data[first]), last - first), finish);
+        for (uint8_t i = first; i < last; i++) step->data[i] = data[i];
+    }
+    si5351_step_move(&(step->vco), &(step->vco_step), step->down);
+    si5351_step_move(&(step->ms), &(step->ms_step), step->down);
+    si5351_step_update_state(dev, step);
+finish:
+    return result;
+}
+
+void si5351_step_split(uint64_t numerator, uint32_t denominator, si5351_step_value_t* value)
+{
+    uint64_t whole = numerator / denominator;
+    value->fraction = (uint32_t)(numerator % denominator);
+    value->denominator = denominator;
+    value->frequency = (uint32_t)(whole / 1000);
+    value->millihertz = (uint16_t)(whole % 1000);
+}
+
+void si5351_step_move(si5351_step_value_t* value, const si5351_step_value_t* delta, bool down)
+{
+    if (down) {
+        if (value->fraction < delta->fraction) {
+            value->fraction += value->denominator;
+            if (value->millihertz == 0) {
+                value->millihertz = 1000;
+                value->frequency--;
+            }
+            value->millihertz--;
+        }
+        value->fraction -= delta->fraction;
+        if (value->millihertz < delta->millihertz) {
+            value->millihertz += 1000;
+            value->frequency--;
+        }
+        value->millihertz -= delta->millihertz;
+        value->frequency -= delta->frequency;
+    } else {
+        value->fraction += delta->fraction;
+        if (value->fraction >= value->denominator) {
+            value->fraction -= value->denominator;
+            value->millihertz++;
+        }
+        value->millihertz += delta->millihertz;
+        if (value->millihertz >= 1000) {
+            value->millihertz -= 1000;
+            value->frequency++;
+        }
+        value->frequency += delta->frequency;
+    }
+}
+
+void si5351_step_update_state(si5351_t* dev, si5351_step_t* step)
+{
+    // the same rounding as the rest of the state, frequency to the nearest Hz
+    bool up = (step->vco.millihertz >= 500);
+    dev->pll[step->pll].frequency = step->vco.frequency + up;
+    dev->pll[step->pll].error = (int32_t)step->vco.millihertz - (up ? 1000 : 0);
+    up = (step->ms.millihertz >= 500);
+    dev->ms[step->clk].frequency = step->ms.frequency + up;
+    dev->ms[step->clk].error = (int32_t)step->ms.millihertz - (up ? 1000 : 0);
+}
+
+si5351_err_t si5351_step_init(si5351_step_t* step, si5351_ms_clk_reg_t clk, uint64_t frequency, int64_t delta)
+{
+    return si5351_dev_step_init(&chip, step, clk, frequency, delta);
+}
+
+si5351_err_t si5351_step(si5351_step_t* step)
+{
+    return si5351_dev_step(&chip, step);
+}
@@ -0,0 +1,67 @@
+/*
+ * si5351_step.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_STEP_H_
+#define _SI5351_STEP_H_
+
+
+#include "si5351.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Constant frequency steps on the PLL of an output with an integer multisynth.
+// P1/P2 move by a precomputed amount with carry, a step writes only the
+// changed parameter registers. All outputs on the PLL move together, only the
+// state of the stepped output is kept up to date.
+typedef struct {
+    uint32_t frequency;             // Hz, the integer part
+    uint16_t millihertz;
+    uint32_t fraction;              // of a millihertz, in 1 / denominator
+    uint32_t denominator;
+} si5351_step_value_t;
+
+typedef struct {
+    si5351_pll_reg_t pll;
+    si5351_ms_clk_reg_t clk;
+    bool down;
+    uint32_t steps_left;
+    uint32_t p1;
+    uint32_t p2;
+    uint32_t p3;
+    uint32_t step_p1;
+    uint32_t step_p2;
+    si5351_step_value_t vco;
+    si5351_step_value_t vco_step;
+    si5351_step_value_t ms;
+    si5351_step_value_t ms_step;
+    uint8_t data[SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH];
+} si5351_step_t;
+
+
+// frequency and delta are the output frequency and its step in mHz, delta < 0 steps down
+si5351_err_t si5351_dev_step_init(si5351_t* dev, si5351_step_t* step, si5351_ms_clk_reg_t clk, uint64_t frequency, int64_t delta);
+si5351_err_t si5351_dev_step(si5351_t* dev, si5351_step_t* step);
+
+si5351_err_t si5351_step_init(si5351_step_t* step, si5351_ms_clk_reg_t clk, uint64_t frequency, int64_t delta);
+si5351_err_t si5351_step(si5351_step_t* step);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_STEP_H_
@@ -0,0 +1,233 @@
+/*
+ * si5351_stream.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351_stream.h"
+#include "si5351_private.h"
+#include "si5351_table.h"
+#include <string.h>
+
+
+// function prototype
+si5351_err_t si5351_stream_apply(si5351_t* dev, si5351_stream_t* stream, int32_t sample);
+void si5351_stream_update_rate(si5351_stream_t* stream);
+
+
+#define SI5351_STREAM_K_bp              24
+// SCL clocks of one update: start, address, register, data bytes with ACK, stop
+#define SI5351_STREAM_UPDATE_BITS(n)    (((n) + 2) * 9 + 2)
+
+
+si5351_err_t si5351_stream_init(si5351_stream_t* stream, int32_t* buffer, uint16_t size,
+                                uint32_t sample_rate, uint32_t scl_hz, si5351_stream_policy_t policy)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((stream == NULL) || (buffer == NULL) || (size == 0) || (sample_rate == 0) || (scl_hz == 0)) goto finish;
+    if ((policy != SI5351_STREAM_DECIMATE) && (policy != SI5351_STREAM_DROP)) goto finish;
+    memset(stream, 0, sizeof(si5351_stream_t));
+    stream->buffer = buffer;
+    stream->size = size;
+    stream->sample_rate = sample_rate;
+    stream->scl_hz = scl_hz;
+    stream->policy = policy;
+    si5351_stream_update_rate(stream);
+    result = SI5351_OK;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_stream_write(si5351_stream_t* stream, const int32_t* samples, uint16_t count, uint16_t* written)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((stream == NULL) || (stream->buffer == NULL) || (samples == NULL)) goto finish;
+    uint32_t head = stream->head;
+    uint16_t n = 0;
+    while ((n < count) && (head - stream->tail < stream->size)) {
+        stream->buffer[head % stream->size] = samples[n++];
+        head++;
+    }
+    // published after the samples, the consumer may run from an interrupt
+    stream->head = head;
+    if (written != NULL) *written = n;
+    result = SI5351_OK;
+finish:
+    return result;
+}
+
+uint32_t si5351_stream_get_achieved_rate(const si5351_stream_t* stream)
+{
+    if (stream->elapsed_usec == 0) return 0;
+    return (uint32_t)((uint64_t)stream->updates * 1000000 / stream->elapsed_usec);
+}
+
+si5351_err_t si5351_dev_stream_start(si5351_t* dev, si5351_stream_t* stream, si5351_ms_clk_reg_t clk, uint64_t frequency)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((stream == NULL) || (stream->buffer == NULL) || (frequency == 0)) goto finish;
+    if ((clk < SI5351_MS_CLK0) || (clk >= SI5351_MS_CLK_COUNT)) goto finish;
+    if (!dev->initialised || !dev->ms[clk].configured) {
+        result = SI5351_ERR_NOT_INITIALISED;
+        goto finish;
+    }
+    if ((dev->bus == NULL) || (dev->bus->get_time_usec == NULL)) {
+        result = SI5351_ERR_INVALID_STATE;
+        goto finish;
+    }
+    si5351_pll_reg_t pll = dev->ms[clk].pll;
+    // PLLB of the B variant is the VCXO PLL, its fraction is fixed
+    if ((pll == SI5351_PLLB) && si5351_is_variant_b(dev->variant)) goto finish;
+    uint16_t divider;
+    SI5351_GOTO_ON_ERROR(si5351_get_integer_divider(dev, clk, &divider), finish);
+    result = SI5351_ERR_INVALID_ARG;
+    uint8_t r = dev->ms[clk].r_div >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp;
+    uint32_t in_frequency = si5351_get_pll_source_frequency(dev, pll);
+    if (in_frequency == 0) goto finish;
+    uint64_t reference = (uint64_t)in_frequency * 1000;
+    uint64_t vco_freq = frequency * divider << r;
+    uint32_t c = SI5351_MULTISYNTH_P3_bm;
+    uint64_t a = vco_freq / reference;
+    uint64_t b = SI5351_DIVIDE_ROUND((vco_freq % reference) * c, reference);
+    si5351_table_entry_t entry;
+    SI5351_GOTO_ON_ERROR(si5351_table_set_pll_entry(pll, in_frequency, a + b / c, (uint32_t)(b % c), c, &entry), finish);
+    SI5351_GOTO_ON_ERROR(si5351_dev_apply_table_entry(dev, &entry), finish);
+    uint64_t scale = ((uint64_t)divider << r) * c;
+    stream->k = ((scale / reference) << SI5351_STREAM_K_bp) + (((scale % reference) << SI5351_STREAM_K_bp) / reference);
+    stream->b_centre = (int64_t)(a * c + b);
+    stream->b = stream->b_centre;
+#if (SI5351_ALLOW_OVERCLOCKING == 0)
+    stream->b_min = (int64_t)(((uint64_t)SI5351_PLL_VCO_MIN * c + in_frequency - 1) / in_frequency);
+    stream->b_max = (int64_t)((uint64_t)SI5351_PLL_VCO_MAX * c / in_frequency);
+#else
+    stream->b_min = (int64_t)SI5351_PLL_INT_MIN * c;
+    stream->b_max = (int64_t)SI5351_PLL_INT_MAX * c;
+#endif
+    memcpy(stream->data, entry.data, SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH);
+    si5351_get_parameters(stream->data, &(stream->p1), &(stream->p2), &(stream->p3));
+    stream->reg = entry.reg;
+    stream->position = 0;
+    stream->updates = 0;
+    stream->bytes = 0;
+    stream->dropped = 0;
+    stream->decimated = 0;
+    stream->clipped = 0;
+    stream->underruns = 0;
+    stream->elapsed_usec = 0;
+    stream->last_usec = dev->bus->get_time_usec(dev->bus->ctx);
+    si5351_stream_update_rate(stream);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_dev_stream_service(si5351_t* dev, si5351_stream_t* stream)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_STATE;
+    if ((stream == NULL) || (stream->reg == 0)) goto finish;
+    result = SI5351_OK;
+    uint32_t now = dev->bus->get_time_usec(dev->bus->ctx);
+    stream->elapsed_usec += now - stream->last_usec;
+    stream->last_usec = now;
+    // the samples whose time has come, the first one is due at start
+    uint64_t due = stream->elapsed_usec * stream->sample_rate / 1000000 + 1;
+    uint32_t head = stream->head;
+    uint32_t tail = stream->tail;
+    uint32_t available = head - tail;
+    uint32_t pending = (due > stream->position) ? (uint32_t)(due - stream->position) : 0;
+    if (pending > available) {
+        stream->underruns++;
+        pending = available;
+    }
+    if (stream->policy == SI5351_STREAM_DROP) {
+        if (pending == 0) goto finish;
+        stream->dropped += pending - 1;
+        tail += pending - 1;
+        SI5351_GOTO_ON_ERROR(si5351_stream_apply(dev, stream, stream->buffer[tail % stream->size]), finish);
+        stream->tail = tail + 1;
+        stream->position += pending;
+    } else {
+        uint16_t n = stream->decimation;
+        if (pending < n) goto finish;
+        // whole blocks the bus is behind on are dropped, the newest one is averaged
+        uint32_t skip = (pending / n - 1) * n;
+        stream->dropped += skip;
+        tail += skip;
+        int64_t sum = 0;
+        for (uint16_t i = 0; i < n; i++) {
+            sum += stream->buffer[(tail + i) % stream->size];
+        }
+        SI5351_GOTO_ON_ERROR(si5351_stream_apply(dev, stream, (int32_t)(sum / n)), finish);
+        stream->decimated += n - 1;
+        stream->tail = tail + n;
+        stream->position += skip + n;
+    }
+    si5351_stream_update_rate(stream);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_stream_apply(si5351_t* dev, si5351_stream_t* stream, int32_t sample)
+{
+    si5351_err_t result = SI5351_OK;
+    int64_t b = stream->b_centre + ((int64_t)sample * (int64_t)stream->k) / (1LL << SI5351_STREAM_K_bp);
+    if (b < stream->b_min) {
+        b = stream->b_min;
+        stream->clipped++;
+    } else if (b > stream->b_max) {
+        b = stream->b_max;
+        stream->clipped++;
+    }
+    // P1 = floor(128 * b / c) - 512 and P2 = 128 * b mod c, a division only on a carry
+    int64_t p2 = (int64_t)stream->p2 + (b - stream->b) * 128;
+    stream->b = b;
+    if ((p2 < 0) || (p2 >= stream->p3)) {
+        int64_t carry = p2 / stream->p3;
+        if (p2 < carry * stream->p3) carry--;
+        stream->p1 = (uint32_t)((int64_t)stream->p1 + carry);
+        p2 -= carry * stream->p3;
+    }
+    stream->p2 = (uint32_t)p2;
+    uint8_t data[SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH];
+    si5351_put_parameters(data, stream->p1, stream->p2, stream->p3);
+    // only the registers between the first and the last changed byte
+    uint8_t first = 0;
+    uint8_t last = SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH;
+    while ((first < last) && (data[first] == stream->data[first])) first++;
+    while ((last > first) && (data[last - 1] == stream->data[last - 1])) last--;
+    if (first < last) {
+        SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, stream->reg + first, &(data[first]), last - first), finish);
+        memcpy(&(stream->data[first]), &(data[first]), last - first);
+        stream->bytes += last - first;
+    }
+    stream->updates++;
+finish:
+    return result;
+}
+
+void si5351_stream_update_rate(si5351_stream_t* stream)
+{
+    // the average update so far, a whole parameter block before the first one
+    uint32_t bytes = SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH;
+    if (stream->updates != 0) bytes = (stream->bytes + stream->updates - 1) / stream->updates;
+    stream->rate = stream->scl_hz / SI5351_STREAM_UPDATE_BITS(bytes);
+    if (stream->rate == 0) stream->rate = 1;
+    uint32_t decimation = (stream->sample_rate + stream->rate - 1) / stream->rate;
+    if (decimation == 0) decimation = 1;
+    // a block never outgrows the ring, it could not fill up to be averaged
+    stream->decimation = (decimation > stream->size) ? stream->size : (uint16_t)decimation;
+}
+
+si5351_err_t si5351_stream_start(si5351_stream_t* stream, si5351_ms_clk_reg_t clk, uint64_t frequency)
+{
+    return si5351_dev_stream_start(&chip, stream, clk, frequency);
+}
+
+si5351_err_t si5351_stream_service(si5351_stream_t* stream)
+{
+    return si5351_dev_stream_service(&chip, stream);
+}
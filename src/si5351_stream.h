@@ -0,0 +1,89 @@
+/*
+ * si5351_stream.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_STREAM_H_
+#define _SI5351_STREAM_H_
+
+
+#include "si5351.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef enum {
+    SI5351_STREAM_DECIMATE = 0,     // average blocks of samples down to the rate the bus keeps up with
+    SI5351_STREAM_DROP              // play the newest due sample, the ones the bus missed are dropped
+} si5351_stream_policy_t;
+
+// Frequency modulation from a ring buffer of samples, mHz offsets from the
+// centre of an integer output. The samples move the PLL fraction of the output
+// (as the VFO mode) on a fixed denominator, a sample is a P1/P2 delta and only
+// the changed bytes are written. si5351_stream_write() is the producer side,
+// si5351_stream_service() is called as often as possible and plays the samples
+// due at sample_rate by the bus get_time_usec(). The update rate the bus can
+// take is estimated from scl_hz and the bytes per update so far, a decimation
+// block is at most the ring size. The chip state keeps the centre frequency
+// while streaming.
+typedef struct {
+    int32_t* buffer;
+    uint16_t size;
+    volatile uint32_t head;         // samples written, the producer side
+    volatile uint32_t tail;         // samples consumed
+    uint32_t sample_rate;           // Hz
+    uint32_t scl_hz;
+    si5351_stream_policy_t policy;
+    uint8_t reg;                    // 0 until started
+    uint64_t k;                     // b per mHz, 24 fraction bits
+    int64_t b_centre;               // feedback divider in 1/c units
+    int64_t b;
+    int64_t b_min;
+    int64_t b_max;
+    uint32_t p1;
+    uint32_t p2;
+    uint32_t p3;
+    uint8_t data[SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH];
+    uint32_t position;              // samples consumed since the start
+    uint32_t last_usec;
+    uint64_t elapsed_usec;
+    // statistics
+    uint32_t rate;                  // updates per second the bus keeps up with
+    uint16_t decimation;
+    uint32_t updates;
+    uint32_t bytes;
+    uint32_t dropped;
+    uint32_t decimated;
+    uint32_t clipped;               // samples out of the VCO range
+    uint32_t underruns;             // services that found the buffer empty before its time
+} si5351_stream_t;
+
+
+si5351_err_t si5351_stream_init(si5351_stream_t* stream, int32_t* buffer, uint16_t size,
+                                uint32_t sample_rate, uint32_t scl_hz, si5351_stream_policy_t policy);
+si5351_err_t si5351_stream_write(si5351_stream_t* stream, const int32_t* samples, uint16_t count, uint16_t* written);
+uint32_t si5351_stream_get_achieved_rate(const si5351_stream_t* stream);
+// frequency in mHz
+si5351_err_t si5351_dev_stream_start(si5351_t* dev, si5351_stream_t* stream, si5351_ms_clk_reg_t clk, uint64_t frequency);
+si5351_err_t si5351_dev_stream_service(si5351_t* dev, si5351_stream_t* stream);
+
+si5351_err_t si5351_stream_start(si5351_stream_t* stream, si5351_ms_clk_reg_t clk, uint64_t frequency);
+si5351_err_t si5351_stream_service(si5351_stream_t* stream);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_STREAM_H_
@@ -0,0 +1,187 @@
+/*
+ * si5351_table.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351_table.h"
+#include "si5351_private.h"
+
+
+// function prototype
+si5351_err_t si5351_table_get_multisynth_entry(si5351_ms_clk_reg_t clk, uint64_t vco_freq, uint64_t frequency, uint8_t r, si5351_table_entry_t* entry);
+si5351_err_t si5351_table_get_pll_entry(si5351_pll_reg_t pll, uint32_t in_frequency, uint64_t vco_freq, si5351_table_entry_t* entry);
+
+
+#define SI5351_TABLE_R_MAX              (SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp)
+
+
+// Frequencies are output frequencies in mHz. The table is built against the
+// current PLL, multisynth and R divider of the output, applying an entry
+// assumes they are left as they were.
+si5351_err_t si5351_dev_build_table(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_table_mode_t mode,
+                                    const uint64_t* frequencies, uint8_t count, si5351_table_entry_t* table)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((frequencies == NULL) || (table == NULL)) goto finish;
+    if ((clk < SI5351_MS_CLK0) || (clk >= SI5351_MS_CLK_COUNT)) goto finish;
+    if (!dev->initialised || !dev->ms[clk].configured || !dev->pll[dev->ms[clk].pll].configured) {
+        result = SI5351_ERR_NOT_INITIALISED;
+        goto finish;
+    }
+    si5351_pll_reg_t pll = dev->ms[clk].pll;
+    uint8_t r = dev->ms[clk].r_div >> SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp;
+    switch (mode) {
+        case SI5351_TABLE_MULTISYNTH: {
+            uint64_t vco_freq = si5351_get_vco_millihertz(dev, pll);
+            for (uint8_t i = 0; i < count; i++) {
+                SI5351_GOTO_ON_ERROR(si5351_table_get_multisynth_entry(clk, vco_freq, frequencies[i], r, &(table[i])), finish);
+            }
+            break;
+        }
+        case SI5351_TABLE_PLL: {
+            // PLLB of the B variant is the VCXO PLL, its fraction is fixed
+            if ((pll == SI5351_PLLB) && si5351_is_variant_b(dev->variant)) goto finish;
+            uint16_t a;
+            SI5351_GOTO_ON_ERROR(si5351_get_integer_divider(dev, clk, &a), finish);
+            uint32_t in_frequency = si5351_get_pll_source_frequency(dev, pll);
+            for (uint8_t i = 0; i < count; i++) {
+                SI5351_GOTO_ON_ERROR(si5351_table_get_pll_entry(pll, in_frequency, (frequencies[i] << r) * a, &(table[i])), finish);
+            }
+            break;
+        }
+        default:
+            goto finish;
+    }
+    result = SI5351_OK;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_dev_apply_table_entry(si5351_t* dev, const si5351_table_entry_t* entry)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    uint8_t control;
+    if (entry == NULL) goto finish;
+    switch (entry->mode) {
+        case SI5351_TABLE_MULTISYNTH:
+            if (entry->index >= SI5351_MS_CLK_COUNT) goto finish;
+            // entries are fractional, the integer mode bit is only touched when set
+            if (entry->index <= SI5351_MS_CLK5) {
+                SI5351_GOTO_ON_ERROR(si5351_read_reg(dev, si5351_clk_register[entry->index], &control), finish);
+                if (control & SI5351_CLK_CONTROL_MS_INT_bm) {
+                    SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, si5351_clk_register[entry->index], control & ~(SI5351_CLK_CONTROL_MS_INT_bm)), finish);
+                }
+            }
+            SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, entry->reg, (uint8_t*)entry->data, entry->count), finish);
+            break;
+        case SI5351_TABLE_PLL:
+            if (entry->index >= SI5351_PLL_COUNT) goto finish;
+            SI5351_GOTO_ON_ERROR(si5351_read_reg(dev, si5351_pll_int_register[entry->index], &control), finish);
+            if (control & SI5351_CLK_CONTROL_FB_INT_bm) {
+                SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, si5351_pll_int_register[entry->index], control & ~(SI5351_CLK_CONTROL_FB_INT_bm)), finish);
+            }
+            SI5351_GOTO_ON_ERROR(si5351_write_regs(dev, entry->reg, (uint8_t*)entry->data, entry->count), finish);
+            break;
+        default:
+            goto finish;
+    }
+    si5351_table_set_state(dev, entry);
+finish:
+    return result;
+}
+
+void si5351_table_set_state(si5351_t* dev, const si5351_table_entry_t* entry)
+{
+    if (entry->mode == SI5351_TABLE_MULTISYNTH) {
+        dev->ms[entry->index].frequency = entry->frequency;
+        dev->ms[entry->index].error = entry->error;
+        if (entry->index <= SI5351_MS_CLK5) {
+            dev->ms[entry->index].r_div = (si5351_clk_r_div_t)(entry->data[2] & SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bm);
+        }
+    } else {
+        dev->pll[entry->index].frequency = entry->frequency;
+        dev->pll[entry->index].error = entry->error;
+    }
+}
+
+si5351_err_t si5351_table_get_multisynth_entry(si5351_ms_clk_reg_t clk, uint64_t vco_freq, uint64_t frequency, uint8_t r, si5351_table_entry_t* entry)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    uint16_t a;
+    uint32_t b, c;
+    if (frequency == 0) goto finish;
+    entry->mode = SI5351_TABLE_MULTISYNTH;
+    entry->index = clk;
+    entry->reg = si5351_multisynth_register[clk];
+    if ((clk == SI5351_MS_CLK6) || (clk == SI5351_MS_CLK7)) {
+        // the R divider of CLK6 and CLK7 lives in a shared register, it stays
+        if (!si5351_get_output_divider(clk, vco_freq, frequency << r, &a, &b, &c)) goto finish;
+        entry->data[0] = (uint8_t)a;
+        entry->count = 1;
+    } else {
+        // the R divider is part of the burst, dividers below 8 need integer mode
+        for (r = 0; r <= SI5351_TABLE_R_MAX; r++) {
+            if (si5351_get_output_divider(clk, vco_freq, frequency << r, &a, &b, &c) && (a >= SI5351_MULTISYNTH_FRAC_0_TO_5_MIN)) break;
+        }
+        if (r > SI5351_TABLE_R_MAX) goto finish;
+        SI5351_GOTO_ON_ERROR(si5351_set_parameters(entry->data, a, b, c), finish);
+        entry->data[2] |= (uint8_t)(r << SI5351_MULTISYNTH0_PARAMETERS_R_DIVIDER_bp);
+        entry->count = SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH;
+    }
+    uint64_t ms_frequency = SI5351_DIVIDE_ROUND(vco_freq * c, (uint64_t)a * c + b);
+    entry->frequency = (uint32_t)SI5351_DIVIDE_ROUND(ms_frequency, 1000);
+    entry->error = (int32_t)(ms_frequency - (uint64_t)entry->frequency * 1000);
+    result = SI5351_OK;
+finish:
+    return result;
+}
+
+si5351_err_t si5351_table_get_pll_entry(si5351_pll_reg_t pll, uint32_t in_frequency, uint64_t vco_freq, si5351_table_entry_t* entry)
+{
+    uint64_t reference = (uint64_t)in_frequency * 1000;
+    uint64_t a = vco_freq / reference;
+    uint32_t b, c;
+    si5351_get_best_fraction(vco_freq % reference, reference, SI5351_MULTISYNTH_P3_bm, &b, &c);
+    if (b == c) {
+        a++;
+        b = 0;
+        c = 1;
+    }
+    return si5351_table_set_pll_entry(pll, in_frequency, a, b, c, entry);
+}
+
+si5351_err_t si5351_table_set_pll_entry(si5351_pll_reg_t pll, uint32_t in_frequency, uint64_t a, uint32_t b, uint32_t c, si5351_table_entry_t* entry)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if ((a < SI5351_PLL_INT_MIN) || (a > SI5351_PLL_INT_MAX)) goto finish;
+    uint32_t frequency = (uint32_t)(SI5351_DIVIDE_ROUND((uint64_t)in_frequency * b, c) + in_frequency * a);
+#if (SI5351_ALLOW_OVERCLOCKING == 0)
+    if ((frequency < SI5351_PLL_VCO_MIN) || (frequency > SI5351_PLL_VCO_MAX)) goto finish;
+#endif
+    SI5351_GOTO_ON_ERROR(si5351_set_parameters(entry->data, (uint32_t)a, b, c), finish);
+    entry->mode = SI5351_TABLE_PLL;
+    entry->index = pll;
+    entry->reg = (pll == SI5351_PLLA) ? SI5351_MULTISYNTH_NA_PARAMETERS : SI5351_MULTISYNTH_NB_PARAMETERS;
+    entry->count = SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH;
+    entry->frequency = frequency;
+    entry->error = si5351_get_vco_error(in_frequency, frequency, (uint32_t)a, b, c);
+finish:
+    return result;
+}
+
+si5351_err_t si5351_build_table(si5351_ms_clk_reg_t clk, si5351_table_mode_t mode,
+                                const uint64_t* frequencies, uint8_t count, si5351_table_entry_t* table)
+{
+    return si5351_dev_build_table(&chip, clk, mode, frequencies, count, table);
+}
+
+si5351_err_t si5351_apply_table_entry(const si5351_table_entry_t* entry)
+{
+    return si5351_dev_apply_table_entry(&chip, entry);
+}
@@ -0,0 +1,58 @@
+/*
+ * si5351_table.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_TABLE_H_
+#define _SI5351_TABLE_H_
+
+
+#include "si5351.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define SI5351_TABLE_DATA_LENGTH            SI5351_MULTISYNTH_0_TO_5_PARAMETERS_LENGTH
+
+typedef enum {
+    SI5351_TABLE_MULTISYNTH,        // retune the output multisynth, the PLL stays
+    SI5351_TABLE_PLL                // retune the PLL of the output, its integer multisynth stays
+} si5351_table_mode_t;
+
+// One pre-encoded register burst, applied with a single bus write.
+typedef struct {
+    uint8_t mode;
+    uint8_t index;                  // output for SI5351_TABLE_MULTISYNTH, PLL for SI5351_TABLE_PLL
+    uint8_t reg;
+    uint8_t count;
+    uint8_t data[SI5351_TABLE_DATA_LENGTH];
+    uint32_t frequency;             // Hz, of the retuned multisynth or PLL
+    int32_t error;                  // mHz, achieved minus frequency
+} si5351_table_entry_t;
+
+
+si5351_err_t si5351_dev_build_table(si5351_t* dev, si5351_ms_clk_reg_t clk, si5351_table_mode_t mode,
+                                    const uint64_t* frequencies, uint8_t count, si5351_table_entry_t* table);
+si5351_err_t si5351_dev_apply_table_entry(si5351_t* dev, const si5351_table_entry_t* entry);
+
+si5351_err_t si5351_build_table(si5351_ms_clk_reg_t clk, si5351_table_mode_t mode,
+                                const uint64_t* frequencies, uint8_t count, si5351_table_entry_t* table);
+si5351_err_t si5351_apply_table_entry(const si5351_table_entry_t* entry);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_TABLE_H_
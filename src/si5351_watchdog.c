@@ -0,0 +1,169 @@
+/*
+ * si5351_watchdog.c
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#include "si5351_watchdog.h"
+#include "si5351_private.h"
+#include <string.h>
+
+
+// function prototype
+si5351_err_t si5351_watchdog_compare(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count, uint8_t* differ);
+si5351_err_t si5351_watchdog_read_shadowed(si5351_t* dev, uint8_t reg, uint8_t* differ);
+si5351_err_t si5351_watchdog_repair(si5351_t* dev, uint8_t* differ, uint8_t* head);
+
+
+#define SI5351_WATCHDOG_IS_SET(bits, reg)   ((bits)[(reg) / 8] & (1 << ((reg) % 8)))
+
+
+#define SI5351_WATCHDOG_HEAD_LENGTH         (SI5351_CLK7_CONTROL + 1)
+
+
+si5351_err_t si5351_dev_watchdog_check(si5351_t* dev, si5351_watchdog_t* watchdog, bool full)
+{
+    si5351_err_t result = SI5351_ERR_INVALID_ARG;
+    if (watchdog == NULL) goto finish;
+    if (!dev->initialised) {
+        result = SI5351_ERR_NOT_INITIALISED;
+        goto finish;
+    }
+    watchdog->checks++;
+    uint8_t data[SI5351_WATCHDOG_HEAD_LENGTH];
+    SI5351_GOTO_ON_ERROR(si5351_read_burst(dev, SI5351_DEVICE_STATUS, data, sizeof(data)), finish);
+    if (data[SI5351_DEVICE_STATUS] & SI5351_DEVICE_STATUS_SYS_INIT_bm) {
+        // the chip is still loading its defaults
+        uint8_t timeout = SI5351_POWERUP_TIME_ms;
+        uint8_t status = SI5351_DEVICE_STATUS_SYS_INIT_bm;
+        while (status & SI5351_DEVICE_STATUS_SYS_INIT_bm) {
+            if (timeout == 0) {
+                result = SI5351_ERR_TIMEOUT;
+                goto finish;
+            }
+            dev->bus->delay_msec(dev->bus->ctx, 1);
+            timeout--;
+            SI5351_GOTO_ON_ERROR(si5351_i2c_read(dev, SI5351_DEVICE_STATUS, &status, 1), finish);
+        }
+        SI5351_GOTO_ON_ERROR(si5351_read_burst(dev, SI5351_DEVICE_STATUS, data, sizeof(data)), finish);
+    }
+    uint8_t differ[(SI5351_REGISTER_COUNT + 7) / 8];
+    memset(differ, 0x00, sizeof(differ));
+    bool drift = (si5351_watchdog_compare(dev, SI5351_DEVICE_STATUS, data, sizeof(data), differ) == SI5351_ERR_FAIL);
+    bool sys_init = ((data[SI5351_INTERRUPT_STATUS_STICKY] & SI5351_DEVICE_STATUS_SYS_INIT_bm) != 0);
+    if (!drift && !sys_init && !full) goto finish;
+    result = si5351_watchdog_read_shadowed(dev, SI5351_WATCHDOG_HEAD_LENGTH, differ);
+    if (result == SI5351_ERR_FAIL) {
+        drift = true;
+    } else if (result != SI5351_OK) {
+        goto finish;
+    }
+    result = SI5351_OK;
+    if (!drift) {
+        // a reset that left nothing to repair, the chip runs as intended
+        if (sys_init) {
+            result = si5351_write_reg(dev, SI5351_INTERRUPT_STATUS_STICKY, data[SI5351_INTERRUPT_STATUS_STICKY] & ~SI5351_DEVICE_STATUS_SYS_INIT_bm);
+        }
+        goto finish;
+    }
+    watchdog->rewritten = 0;
+    for (uint16_t reg = 0; reg < SI5351_REGISTER_COUNT; reg++) {
+        if (SI5351_WATCHDOG_IS_SET(differ, reg)) watchdog->rewritten++;
+    }
+    SI5351_GOTO_ON_ERROR(si5351_watchdog_repair(dev, differ, data), finish);
+    watchdog->recoveries++;
+    if (sys_init) watchdog->sys_inits++;
+finish:
+    return result;
+}
+
+// SI5351_ERR_FAIL when a shadowed register differs from the chip
+si5351_err_t si5351_watchdog_compare(si5351_t* dev, uint8_t reg, uint8_t* data, uint8_t count, uint8_t* differ)
+{
+    si5351_err_t result = SI5351_OK;
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t r = reg + i;
+        if (!si5351_is_reg_cached(dev, r) || si5351_is_reg_volatile(r)) continue;
+        if (data[i] != dev->regs[r]) {
+            differ[r / 8] |= (1 << (r % 8));
+            result = SI5351_ERR_FAIL;
+        }
+    }
+    return result;
+}
+
+si5351_err_t si5351_watchdog_read_shadowed(si5351_t* dev, uint8_t reg, uint8_t* differ)
+{
+    si5351_err_t result = SI5351_OK;
+    uint8_t data[SI5351_I2C_BURST_MAX];
+    bool drift = false;
+    uint16_t r = reg;
+    while (r < SI5351_REGISTER_COUNT) {
+        if (!si5351_is_reg_cached(dev, r) || si5351_is_reg_volatile(r)) {
+            r++;
+            continue;
+        }
+        // one read for each run of shadowed registers
+        uint8_t count = 1;
+        while ((r + count < SI5351_REGISTER_COUNT) && (count < SI5351_I2C_BURST_MAX)
+                && si5351_is_reg_cached(dev, r + count) && !si5351_is_reg_volatile(r + count)) {
+            count++;
+        }
+        SI5351_GOTO_ON_ERROR(si5351_read_burst(dev, r, data, count), finish);
+        if (si5351_watchdog_compare(dev, r, data, count, differ) != SI5351_OK) drift = true;
+        r += count;
+    }
+    if (drift) result = SI5351_ERR_FAIL;
+finish:
+    return result;
+}
+
+// head holds registers 0..23 as read from the chip
+si5351_err_t si5351_watchdog_repair(si5351_t* dev, uint8_t* differ, uint8_t* head)
+{
+    si5351_err_t result = SI5351_OK;
+    uint8_t output_enable = dev->regs[SI5351_OUTPUT_ENABLE_CONTROL];
+    bool output_enable_cached = si5351_is_reg_cached(dev, SI5351_OUTPUT_ENABLE_CONTROL);
+    if (head[SI5351_OUTPUT_ENABLE_CONTROL] != 0xFF) {
+        SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, 0xFF), finish);
+    }
+    // the shadow holds the intended contents, marking a register dirty resends it
+    differ[SI5351_OUTPUT_ENABLE_CONTROL / 8] &= ~(1 << (SI5351_OUTPUT_ENABLE_CONTROL % 8));
+    si5351_dev_begin(dev);
+    for (uint8_t i = 0; i < sizeof(dev->regs_dirty); i++) {
+        dev->regs_dirty[i] |= differ[i];
+    }
+    SI5351_GOTO_ON_ERROR(si5351_dev_commit(dev), finish);
+    // the PLLs are reset when their source, feedback divider or the crystal load was rewritten
+    bool pll_changed = SI5351_WATCHDOG_IS_SET(differ, SI5351_PLL_INPUT_SOURCE) || SI5351_WATCHDOG_IS_SET(differ, SI5351_CRYSTAL_INTERNAL_LOAD_CAP)
+            || SI5351_WATCHDOG_IS_SET(differ, SI5351_CLK6_CONTROL) || SI5351_WATCHDOG_IS_SET(differ, SI5351_CLK7_CONTROL);
+    for (uint8_t reg = SI5351_MULTISYNTH_NA_PARAMETERS; reg < SI5351_MULTISYNTH_NB_PARAMETERS + SI5351_MULTISYNTH_NX_PARAMETERS_LENGTH; reg++) {
+        if (SI5351_WATCHDOG_IS_SET(differ, reg)) pll_changed = true;
+    }
+    if (pll_changed) {
+        SI5351_GOTO_ON_ERROR(si5351_dev_reset_pll(dev), finish);
+        uint8_t pll_mask = 0;
+        for (uint8_t pll = SI5351_PLLA; pll < SI5351_PLL_COUNT; pll++) {
+            if (dev->pll[pll].configured) pll_mask |= (1 << pll);
+        }
+        if (pll_mask != 0) SI5351_GOTO_ON_ERROR(si5351_dev_wait_lock(dev, pll_mask, SI5351_PLL_LOCK_TIME_ms * 1000UL, NULL), finish);
+    }
+    if (output_enable_cached) SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, SI5351_OUTPUT_ENABLE_CONTROL, output_enable), finish);
+    // SYS_INIT is handled, the other sticky bits are left to the event service
+    uint8_t sticky = head[SI5351_INTERRUPT_STATUS_STICKY];
+    if (sticky & SI5351_DEVICE_STATUS_SYS_INIT_bm) {
+        SI5351_GOTO_ON_ERROR(si5351_write_reg(dev, SI5351_INTERRUPT_STATUS_STICKY, sticky & ~SI5351_DEVICE_STATUS_SYS_INIT_bm), finish);
+    }
+finish:
+    return result;
+}
+
+si5351_err_t si5351_watchdog_check(si5351_watchdog_t* watchdog, bool full)
+{
+    return si5351_dev_watchdog_check(&chip, watchdog, full);
+}
@@ -0,0 +1,50 @@
+/*
+ * si5351_watchdog.h
+ *
+ * Created on: 16 paź 2026
+ *     Author: Krzysztof Markiewicz <obbo.pl>
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 Krzysztof Markiewicz
+ */
+
+#ifndef _SI5351_WATCHDOG_H_
+#define _SI5351_WATCHDOG_H_
+
+
+#include "si5351.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Supervision of the chip contents against the register shadow of si5351_t.
+// A check reads registers 0..23 (status, sticky, output enable, PLL source and
+// clock controls) in one burst. On SYS_INIT or a shadowed register that
+// differs, or on every check when full is set, the other shadowed registers
+// are read as well. The registers that differ are rewritten in the datasheet
+// order: outputs disabled, registers programmed in the fewest bursts, PLL
+// reset and lock wait (when a PLL register was rewritten), outputs enabled.
+typedef struct {
+    uint32_t checks;
+    uint32_t recoveries;
+    uint32_t sys_inits;             // recoveries after a power-on reset of the chip
+    uint16_t rewritten;             // registers rewritten by the last recovery
+} si5351_watchdog_t;
+
+
+si5351_err_t si5351_dev_watchdog_check(si5351_t* dev, si5351_watchdog_t* watchdog, bool full);
+
+si5351_err_t si5351_watchdog_check(si5351_watchdog_t* watchdog, bool full);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _SI5351_WATCHDOG_H_